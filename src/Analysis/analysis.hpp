@@ -5,5 +5,7 @@
 #include "basic_types.h"
 #include "criterion_parser.h"
 #include "matching.h"
+#include "scenarios.h"
+#include "criteria_optimizer.h"
 
 #endif
\ No newline at end of file
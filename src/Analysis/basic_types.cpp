@@ -1,14 +1,17 @@
 #include "basic_types.h"
 #include <string>
+#include <utility>
+#include <limits>
+#include <stdexcept>
 
 namespace Fundraising
 {
     std::ostream& operator<<(std::ostream& os, const Analysis::donation_val_t& d)
     {
-        std::string cents_string;
-        if (d.second < 10) cents_string = "0" + std::to_string(d.second);
-        else cents_string = std::to_string(d.second);
-        os << "$" << std::to_string(d.first) << "." << cents_string;
+        std::int64_t cents = d.cents_part();
+        std::string cents_string = (cents < 10) ? "0" + std::to_string(cents) : std::to_string(cents);
+        if (d < Analysis::ZERO) os << "-";
+        os << "$" << std::to_string(d.dollars() < 0 ? -d.dollars() : d.dollars()) << "." << cents_string;
         return os;
     }
 
@@ -34,99 +37,246 @@ namespace Fundraising
 
 namespace Fundraising::Analysis {
 
-    date_time_t::date_time_t(const std::string& date, const std::string& time)
+    //Hand written parsers for the fields of an export. They work 
+    //directly on views of the row, so they never allocate, and reject
+    //anything they don't fully understand.
+
+    //Removes spaces and tabs from both ends of a field
+    static std::string_view trim(std::string_view field)
+    {
+        while (!field.empty() && (field.front() == ' ' || field.front() == '\t'))
+            field.remove_prefix(1);
+        while (!field.empty() && (field.back() == ' ' || field.back() == '\t'))
+            field.remove_suffix(1);
+        return field;
+    } //! trim()
+
+    static bool is_digit(char c)
+    {
+        return c >= '0' && c <= '9';
+    } //! is_digit()
+
+    //Reads between 1 and max_digits digits from the front of text
+    //@param text the text to read from. The digits are removed from it
+    //@param max_digits the most digits to read
+    //@param value receives the number read
+    //@return the number of digits read, 0 if text did not start with a digit
+    static size_t read_number(std::string_view& text, size_t max_digits, int& value)
+    {
+        size_t n = 0;
+        value = 0;
+        while (n < text.size() && n < max_digits && is_digit(text[n]))
+            value = value*10 + (text[n++] - '0');
+        text.remove_prefix(n);
+        return n;
+    } //! read_number()
+
+    //Removes c from the front of text
+    //@return false if text did not start with c
+    static bool read_char(std::string_view& text, char c)
+    {
+        if (text.empty() || text.front() != c)
+            return false;
+        text.remove_prefix(1);
+        return true;
+    } //! read_char()
+
+    [[noreturn]] static void invalid_field(const char* what, std::string_view field)
+    {
+        throw std::runtime_error("Invalid " + std::string(what) + " \"" + std::string(field) + "\"");
+    } //! invalid_field()
+
+    //Parses a date written as M/D/YY, M/D/YYYY, YYYY-MM-DD or YYYY/MM/DD.
+    //Two digit years are taken to be in the 2000s.
+    static std::tuple<int,short,short> parse_date(std::string_view field)
+    {
+        std::string_view text = trim(field);
+        int first, second, third;
+        size_t first_digits = read_number(text, 4, first);
+        if (first_digits == 0 || text.empty() || (text.front() != '/' && text.front() != '-'))
+            invalid_field("date", field);
+        char separator = text.front();
+        text.remove_prefix(1);
+        if (read_number(text, 2, second) == 0 || !read_char(text, separator))
+            invalid_field("date", field);
+        size_t third_digits = read_number(text, 4, third);
+        if (third_digits == 0 || !text.empty())
+            invalid_field("date", field);
+
+        int year, month, day;
+        if (first_digits == 4)
+        {
+            year = first;
+            month = second;
+            day = third;
+            if (third_digits > 2)
+                invalid_field("date", field);
+        }
+        else
+        {
+            if (separator != '/' || first_digits > 2 || (third_digits != 2 && third_digits != 4))
+                invalid_field("date", field);
+            month = first;
+            day = second;
+            year = (third_digits == 2) ? third + 2000 : third;
+        }
+        if (month < 1 || month > 12 || day < 1 || day > 31)
+            invalid_field("date", field);
+        return std::make_tuple(year, static_cast<short>(month), static_cast<short>(day));
+    } //! parse_date()
+
+    //Parses a time written as H:MM or H:MM:SS on a 24 hour clock, or
+    //followed by AM or PM on a 12 hour clock. Fractions of a second
+    //are ignored.
+    static std::tuple<short,short,short> parse_time(std::string_view field)
+    {
+        std::string_view text = trim(field);
+        int hour, min, sec = 0;
+        if (read_number(text, 2, hour) == 0 || !read_char(text, ':') || read_number(text, 2, min) != 2)
+            invalid_field("time", field);
+        if (read_char(text, ':'))
+        {
+            if (read_number(text, 2, sec) != 2)
+                invalid_field("time", field);
+            if (read_char(text, '.'))
+            {
+                while (!text.empty() && is_digit(text.front()))
+                    text.remove_prefix(1);
+            }
+        }
+        text = trim(text);
+        if (!text.empty())
+        {
+            if (text.size() != 2 || (text[1] != 'M' && text[1] != 'm') || hour < 1 || hour > 12)
+                invalid_field("time", field);
+            if (text[0] == 'A' || text[0] == 'a')
+                hour = (hour == 12) ? 0 : hour;
+            else if (text[0] == 'P' || text[0] == 'p')
+                hour = (hour == 12) ? 12 : hour + 12;
+            else
+                invalid_field("time", field);
+        }
+        if (hour > 23 || min > 59 || sec > 59)
+            invalid_field("time", field);
+        return std::make_tuple(static_cast<short>(hour), static_cast<short>(min), static_cast<short>(sec));
+    } //! parse_time()
+
+    static constexpr std::int64_t SECONDS_PER_DAY = 86400;
+
+    //Counts the days from 1970/01/01 to a date in the proleptic Gregorian 
+    //calendar, working in 400 year eras that start on March 1st
+    static std::int64_t days_from_civil(int year, int month, int day)
+    {
+        year -= (month <= 2);
+        std::int64_t era = (year >= 0 ? year : year - 399)/400;
+        std::int64_t year_of_era = year - era*400;
+        std::int64_t day_of_year = (153*(month + (month > 2 ? -3 : 9)) + 2)/5 + day - 1;
+        std::int64_t day_of_era = year_of_era*365 + year_of_era/4 - year_of_era/100 + day_of_year;
+        return era*146097 + day_of_era - 719468;
+    } //! days_from_civil()
+
+    //The inverse of days_from_civil()
+    static std::tuple<int,int,int> civil_from_days(std::int64_t days)
+    {
+        days += 719468;
+        std::int64_t era = (days >= 0 ? days : days - 146096)/146097;
+        std::int64_t day_of_era = days - era*146097;
+        std::int64_t year_of_era = (day_of_era - day_of_era/1460 + day_of_era/36524 - day_of_era/146096)/365;
+        std::int64_t day_of_year = day_of_era - (365*year_of_era + year_of_era/4 - year_of_era/100);
+        std::int64_t shifted_month = (5*day_of_year + 2)/153;
+        int day = static_cast<int>(day_of_year - (153*shifted_month + 2)/5 + 1);
+        int month = static_cast<int>(shifted_month < 10 ? shifted_month + 3 : shifted_month - 9);
+        int year = static_cast<int>(year_of_era + era*400 + (month <= 2));
+        return std::make_tuple(year, month, day);
+    } //! civil_from_days()
+
+    //Splits seconds since the epoch into whole days and the seconds into the day
+    static std::int64_t days_of(std::int64_t seconds)
     {
-        short hour = static_cast<short>(std::stoi(time.substr(0, time.find(":"))));
-        short min = static_cast<short>(std::stoi(time.substr(time.find(":") + 1, time.find(":") + 3)));
-        short sec = static_cast<short>(std::stoi(time.substr(time.length() - 2)));
+        return (seconds >= 0 ? seconds : seconds - (SECONDS_PER_DAY - 1))/SECONDS_PER_DAY;
+    } //! days_of()
 
-        auto donation_time = std::make_tuple(hour, min, sec);
+    static std::int64_t seconds_into_day(std::int64_t seconds)
+    {
+        return seconds - days_of(seconds)*SECONDS_PER_DAY;
+    } //! seconds_into_day()
 
-        short month = static_cast<short>(std::stoi(date.substr(0, 2)));
-        short day = static_cast<short>(std::stoi(date.substr(3, 5)));
-        int year = std::stoi(date.substr(7));
-        if (year < 1e3) year += 2000;
-        auto donation_date = std::make_tuple(year, month, day);
+    date_time_t::date_time_t(std::string_view date, std::string_view time)
+    {
+        auto [year, month, day] = parse_date(date);
+        auto [hour, min, sec] = parse_time(time);
+        _M_seconds = days_from_civil(year, month, day)*SECONDS_PER_DAY + hour*3600 + min*60 + sec;
+    } //! date_time_t()
+
+    date_time_t::date_time_t(int year, int month, int day, int hour, int min, int sec)
+        : _M_seconds(days_from_civil(year, month, day)*SECONDS_PER_DAY + hour*3600 + min*60 + sec)
+    {
 
-        _M_time = donation_time;
-        _M_date = donation_date;
     } //! date_time_t()
 
+    int date_time_t::get_year() const 
+    {
+        return std::get<0>(civil_from_days(days_of(_M_seconds)));
+    } //! get_year()
+
+    int date_time_t::get_month() const 
+    {
+        return std::get<1>(civil_from_days(days_of(_M_seconds)));
+    } //! get_month()
+
+    int date_time_t::get_day() const 
+    {
+        return std::get<2>(civil_from_days(days_of(_M_seconds)));
+    } //! get_day()
+
     short date_time_t::get_hour() const 
     {
-        return std::get<0>(_M_time);
+        return static_cast<short>(seconds_into_day(_M_seconds)/3600);
     } //! get_hour()
 
-    bool operator<(const date_time_t& lhs, const date_time_t& rhs)
+    short date_time_t::get_minute() const 
     {
-        auto lhs_date = lhs._M_date;
-        auto rhs_date = rhs._M_date;
-        //Check if dates are different
-        if (std::get<0>(lhs_date) < std::get<0>(rhs_date)) 
-            return true;
-        if (std::get<1>(lhs_date) < std::get<1>(rhs_date))
-            return true;
-        if(std::get<2>(lhs_date) < std::get<2>(rhs_date))
-            return true;
-        //Date is same, compare times 
-        auto lhs_time = lhs._M_time;
-        auto rhs_time = rhs._M_time;
+        return static_cast<short>(seconds_into_day(_M_seconds)/60 % 60);
+    } //! get_minute()
 
-        if(std::get<0>(lhs_time) < std::get<0>(rhs_time))
-            return true;
-        if (std::get<1>(lhs_time) < std::get<1>(rhs_time))
-            return true;
-        return std::get<2>(lhs_time) < std::get<2>(rhs_time);
-    }//! operator<
-
-    bool operator>(const date_time_t& lhs, const date_time_t& rhs)
+    short date_time_t::get_second() const 
     {
-        auto lhs_date = lhs._M_date;
-        auto rhs_date = rhs._M_date;
-        //Check if dates are different
-        if (std::get<0>(lhs_date) > std::get<0>(rhs_date)) 
-            return true;
-        if (std::get<1>(lhs_date) > std::get<1>(rhs_date))
-            return true;
-        if(std::get<2>(lhs_date) > std::get<2>(rhs_date))
-            return true;
-        //Date is same, compare times 
-        auto lhs_time = lhs._M_time;
-        auto rhs_time = rhs._M_time;
+        return static_cast<short>(seconds_into_day(_M_seconds) % 60);
+    } //! get_second()
 
-        if(std::get<0>(lhs_time) > std::get<0>(rhs_time))
-            return true;
-        if (std::get<1>(lhs_time) > std::get<1>(rhs_time))
-            return true;
-        return std::get<2>(lhs_time) > std::get<2>(rhs_time);
-    }//! operator>
+    void date_time_t::set_date(int year, int month, int day)
+    {
+        _M_seconds = days_from_civil(year, month, day)*SECONDS_PER_DAY + seconds_into_day(_M_seconds);
+    } //! set_date()
 
-    bool operator>=(const date_time_t& lhs, const date_time_t& rhs)
+    void date_time_t::set_time(int hour, int min, int sec)
     {
-        return !(lhs < rhs);
-    }//! operator>=
+        _M_seconds = days_of(_M_seconds)*SECONDS_PER_DAY + hour*3600 + min*60 + sec;
+    } //! set_time()
 
-    bool operator<=(const date_time_t& lhs, const date_time_t& rhs)
+    date_time_t date_time_t::truncate_to_hour() const 
     {
-        return !(lhs > rhs);
-    }//! operator<=
+        date_time_t dt;
+        dt._M_seconds = _M_seconds - seconds_into_day(_M_seconds) % 3600;
+        return dt;
+    } //! truncate_to_hour()
 
-    bool operator==(const date_time_t& lhs, const date_time_t& rhs)
+    date_time_t date_time_t::truncate_to_minute() const 
     {
-        return (lhs >= rhs) && (lhs <= rhs);
-    }//! operator==
+        date_time_t dt;
+        dt._M_seconds = _M_seconds - seconds_into_day(_M_seconds) % 60;
+        return dt;
+    } //! truncate_to_minute()
 
     date_time_t::operator std::string() const 
     {
-        short hour = std::get<0>(_M_time);
-        short min = std::get<1>(_M_time);
-        short sec = std::get<2>(_M_time);
-
-        int year = std::get<0>(_M_date);
-        short month = std::get<1>(_M_date);
-        short day = std::get<2>(_M_date);
+        auto [year, month, day] = civil_from_days(days_of(_M_seconds));
+        std::int64_t seconds = seconds_into_day(_M_seconds);
+        int hour = static_cast<int>(seconds/3600);
+        int min = static_cast<int>(seconds/60 % 60);
+        int sec = static_cast<int>(seconds % 60);
 
-        std::string year_string = (year < 1e3) ? "20" + std::to_string(year) : std::to_string(year);
+        std::string year_string = std::to_string(year);
         std::string month_string = (month < 10) ? "0" + std::to_string(month) : std::to_string(month);
         std::string day_string = (day < 10) ? "0" + std::to_string(day) : std::to_string(day);
 
@@ -138,107 +288,94 @@ namespace Fundraising::Analysis {
             hour_string + ":" + min_string + ":" + sec_string;
     }//! operator std::string
 
-    donation_val_t operator+(const donation_val_t& lhs, const donation_val_t& rhs)
+    donation_val_t make_donation(std::string_view value)
     {
-        int dollars = lhs.first + rhs.first;
-        int cents = lhs.second + rhs.second;
-        if (cents >= 100) 
+        //Accepts an optional - and $, thousands separated by commas and up 
+        //to two decimal places, e.g. 25, 20.5, $1,250.00 or -$5.00
+        std::string_view text = trim(value);
+        //Refunds are exported as negative amounts, with the sign on either 
+        //side of the $
+        bool negative = read_char(text, '-');
+        read_char(text, '$');
+        if (!negative)
+            negative = read_char(text, '-');
+        long long dollars = 0;
+        size_t num_digits = 0;
+        size_t group_digits = 0;
+        bool grouped = false;
+        while (!text.empty() && (is_digit(text.front()) || text.front() == ','))
         {
-            cents = cents - 100;
-            dollars += 1;
+            if (text.front() == ',')
+            {
+                //Commas must separate groups of exactly three digits
+                if (num_digits == 0 || (grouped && group_digits != 3) || (!grouped && group_digits > 3))
+                    invalid_field("donation amount", value);
+                grouped = true;
+                group_digits = 0;
+            }
+            else
+            {
+                dollars = dollars*10 + (text.front() - '0');
+                ++num_digits;
+                ++group_digits;
+                if (dollars > std::numeric_limits<int>::max())
+                    invalid_field("donation amount", value);
+            }
+            text.remove_prefix(1);
         }
-        return std::make_pair(dollars, cents);
-    }//! operator+
-
-    donation_val_t operator-(const donation_val_t& lhs, const donation_val_t& rhs)
-    {
-        int dollars = lhs.first - rhs.first;
-        int cents = lhs.second - rhs.second;
-        if (cents < 0)
+        if (grouped && group_digits != 3)
+            invalid_field("donation amount", value);
+        int cents = 0;
+        if (read_char(text, '.'))
         {
-            cents += 100;
-            dollars -= 1;
-        }
-        return std::make_pair(dollars, cents);
-    }//! operator-
-
-    bool operator<(const donation_val_t& lhs, const donation_val_t& rhs)
-    {
-        if (lhs.first < rhs.first) 
-            return true;
-        if (lhs.first == rhs.first)
-            return lhs.second < rhs.second;
-        return false;
-    }//! operator<
-
-    bool operator>(const donation_val_t& lhs, const donation_val_t& rhs)
-    {
-        if (lhs.first > rhs.first) 
-            return true;
-        if (lhs.first == rhs.first)
-            return lhs.second > rhs.second;
-        return false;
-    }//! operator>
-
-    bool operator<=(const donation_val_t& lhs, const donation_val_t& rhs)
-    {
-        return !(lhs > rhs);
-    }//! operator<=
-
-    bool operator>=(const donation_val_t& lhs, const donation_val_t& rhs)
-    {
-        return !(lhs < rhs);
-    }//! operator>=
-
-    bool operator==(const donation_val_t& lhs, const donation_val_t& rhs)
-    {
-        return (lhs <= rhs) && (lhs >= rhs);
-    }//! operator==
-
-    donation_val_t make_donation(const std::string& value)
-    {
-        size_t decimal_index = value.find('.');
-        int dollar_val = std::stoi(value.substr(0, decimal_index));
-        int cents;
-        if (decimal_index == std::string::npos) cents = 0;
-        else {
-            cents = std::stoi(value.substr(decimal_index + 1));
-            if (decimal_index == value.size() - 2) cents *= 10;
+            size_t cents_digits = read_number(text, 2, cents);
+            if (cents_digits == 1)
+                cents *= 10;
+            //Extra places are only allowed if they don't change the amount
+            while (!text.empty() && text.front() == '0')
+                text.remove_prefix(1);
+            if (cents_digits == 0 && num_digits == 0)
+                invalid_field("donation amount", value);
         }
-        return std::make_pair(dollar_val, cents);
+        else if (num_digits == 0)
+            invalid_field("donation amount", value);
+        if (!text.empty())
+            invalid_field("donation amount", value);
+        money amt(dollars, cents);
+        return negative ? -amt : amt;
     }//! make_donation()
 
     donation_val_t make_donation(int dollar, int cents)
     {
-        return std::make_pair(dollar, cents);
+        return money(dollar, cents);
     }//! make_donation()
 
     donation_t::donation_t(const date_time_t& timestamp,
                 const donation_val_t& amt, 
-                const std::string& donor_first_name, 
-                const std::string& donor_last_name,
-                const std::string& donor_email,
-                const std::string& donor_phone,
-                const std::string& donor_relation,
-                const std::string& dancer_name,
-                const std::string& dancer_email,
-                const std::string& dancer_house,
-                const std::string& dancer_team,
-                const std::string& dancer_type,
-                const std::string& dancer_id) :
+                std::string donor_first_name, 
+                std::string donor_last_name,
+                std::string donor_email,
+                std::string donor_phone,
+                symbol_t donor_relation,
+                std::string dancer_name,
+                std::string dancer_email,
+                symbol_t dancer_house,
+                symbol_t dancer_team,
+                symbol_t dancer_type,
+                std::string dancer_id) :
                 _M_timestamp(timestamp), 
                 _M_amt(amt),
-                _M_donor_first_name(donor_first_name),
-                _M_donor_last_name(donor_last_name),
-                _M_donor_email(donor_email),
-                _M_donor_phone(donor_phone),
+                _M_donor_first_name(std::move(donor_first_name)),
+                _M_donor_last_name(std::move(donor_last_name)),
+                _M_donor_email(std::move(donor_email)),
+                _M_donor_phone(std::move(donor_phone)),
                 _M_donor_relation(donor_relation),
-                _M_dancer_name(dancer_name),
-                _M_dancer_email(dancer_email),
+                _M_dancer_name(std::move(dancer_name)),
+                _M_dancer_email(std::move(dancer_email)),
                 _M_dancer_house(dancer_house),
                 _M_dancer_team(dancer_team),
                 _M_dancer_role(dancer_type),
-                _M_dancer_id(dancer_id)
+                _M_dancer_id(std::move(dancer_id))
                 {
 
                 }
@@ -247,7 +384,7 @@ namespace Fundraising::Analysis {
             const std::string& last_name,
             const std::string& email,
             const std::string& phone, 
-            const std::string& relation) :
+            symbol_t relation) :
             _M_donor_first_name(first_name),
             _M_donor_last_name(last_name),
             _M_donor_email(email),
@@ -277,9 +414,9 @@ namespace Fundraising::Analysis {
     dancer_t::dancer_t(const std::string& dancer_id,
             const std::string& name,
             const std::string& email,
-            const std::string& role,
-            const std::string& house, 
-            const std::string& team
+            symbol_t role,
+            symbol_t house, 
+            symbol_t team
             ) :
             _M_dancer_id(dancer_id),
             _M_dancer_name(name),
@@ -2,76 +2,83 @@
 #define BASIC_TYPES_H
 
 #include <tuple>
+#include <cstdint>
 #include <ostream>
 #include <type_traits>
 #include <cmath>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
+#include "symbol_table.h"
+#include "money.h"
 
 namespace Fundraising::Analysis {
 
     template<typename..._Tp>
     using output_row_t = std::tuple<_Tp...>;
 
-    //Type to represent date and time
+    //Type to represent date and time, stored as whole seconds since 
+    //1970/01/01 00:00:00 so comparing and hashing are single integer 
+    //operations. The fields are only worked out when they are asked for.
     struct date_time_t
     {
-        //Creates a new date_time_t from formatted date and time strings 
-        //@param date the formatted date string 
-        //@param time the formatted time string
-        date_time_t(const std::string& date, const std::string& time);
+        //Creates a new date_time_t from formatted date and time strings. 
+        //Throws a std::runtime_error if either can't be read.
+        //@param date the date as M/D/YY, M/D/YYYY, YYYY-MM-DD or YYYY/MM/DD
+        //@param time the time as H:MM[:SS] on a 24 hour clock, or with AM/PM
+        date_time_t(std::string_view date, std::string_view time);
+
+        //Creates a new date_time_t from its fields, which must already be valid
+        date_time_t(int year, int month, int day, int hour = 0, int min = 0, int sec = 0);
 
         date_time_t() = default;
-        //Date in year-month-day format
-        std::tuple<int,short,short> _M_date;
-        //Time in hour-min-second dformat
-        std::tuple<short,short,short> _M_time;
+
+        int get_year() const;
+        int get_month() const;
+        int get_day() const;
+        short get_hour() const;
+        short get_minute() const;
+        short get_second() const;
+
+        //Replace the date or the time, keeping the other
+        void set_date(int year, int month, int day);
+        void set_time(int hour, int min, int sec);
+
+        //@return the start of the hour or minute this falls in
+        date_time_t truncate_to_hour() const;
+        date_time_t truncate_to_minute() const;
+
         //Implicitly covert date_time sto std::string 
         //@return date_time_t in format yyyy/mm/dd hh:mm:ss
-        short get_hour() const;
         operator std::string() const;
+
+        //Seconds since 1970/01/01 00:00:00
+        std::int64_t _M_seconds = 0;
     }; //! date_time_t
 
-    bool operator<(const date_time_t& lhs, const date_time_t& rhs);
-    bool operator>(const date_time_t& lhs, const date_time_t& rhs);
-    bool operator>=(const date_time_t& lhs, const date_time_t& rhs);
-    bool operator<=(const date_time_t& lhs, const date_time_t& rhs);
-    bool operator==(const date_time_t& lhs, const date_time_t& rhs);
+    inline bool operator<(const date_time_t& lhs, const date_time_t& rhs) {return lhs._M_seconds < rhs._M_seconds;}
+    inline bool operator>(const date_time_t& lhs, const date_time_t& rhs) {return lhs._M_seconds > rhs._M_seconds;}
+    inline bool operator>=(const date_time_t& lhs, const date_time_t& rhs) {return lhs._M_seconds >= rhs._M_seconds;}
+    inline bool operator<=(const date_time_t& lhs, const date_time_t& rhs) {return lhs._M_seconds <= rhs._M_seconds;}
+    inline bool operator==(const date_time_t& lhs, const date_time_t& rhs) {return lhs._M_seconds == rhs._M_seconds;}
+    inline bool operator!=(const date_time_t& lhs, const date_time_t& rhs) {return lhs._M_seconds != rhs._M_seconds;}
 
     //Types to represent a donation's amount
-    using donation_val_t = std::pair<int, int>;
+    using donation_val_t = money;
 
     //Constant to represent $0.00
-    static const donation_val_t ZERO = std::make_pair(0,0);;
-
-    donation_val_t operator+(const donation_val_t& lhs, const donation_val_t& rhs);
-    donation_val_t operator-(const donation_val_t& lhs, const donation_val_t& rhs);
-
-    template<typename _DTp>
-    donation_val_t operator/(const donation_val_t& lhs, const _DTp& rhs)
-    {
-        double dollars = lhs.first;
-        double cents = lhs.second;
-        //Exploit the fact that abc.d/rhs = abc/rhs + de-2/rhs
-        double dollars_result = dollars/rhs;
-        int new_dollars = static_cast<int>(dollars_result);
-        int cents_result = static_cast<int>(std::round(cents/rhs));
-        int new_cents = cents_result + static_cast<int>(std::round((dollars_result - new_dollars)*100));
-        return std::make_pair(new_dollars, new_cents);
-    } //! operator/
-
-    //Comparison operator overloads
-    bool operator<(const donation_val_t& lhs, const donation_val_t& rhs);
-    bool operator<=(const donation_val_t& lhs, const donation_val_t& rhs);
-    bool operator>(const donation_val_t& lhs, const donation_val_t& rhs);
-    bool operator>=(const donation_val_t& lhs, const donation_val_t& rhs);
-    bool operator==(const donation_val_t& lhs, const donation_val_t& rhs);
+    static constexpr donation_val_t ZERO = money();
 
-    donation_val_t make_donation(const std::string& donation);
     donation_val_t make_donation(int dollar, int cents);
 
+    //Reads a donation amount such as 25, 20.5, $1,250.00 or -5.00 for a 
+    //refund. Throws a std::runtime_error if the amount can't be read.
+    //@param donation the formatted amount
+    //@return the amount
+    donation_val_t make_donation(std::string_view donation);
+
     //A struct to represent a single donation 
     //Includes information about
     //  1) the date and time of the donation 
@@ -100,17 +107,17 @@ namespace Fundraising::Analysis {
         //                   (dancer, steering, CPT, etc.)
     donation_t(const date_time_t& timestamp,
                 const donation_val_t& amt, 
-                const std::string& donor_first_name, 
-                const std::string& donor_last_name,
-                const std::string& donor_email,
-                const std::string& donor_phone,
-                const std::string& donor_relation,
-                const std::string& dancer_name,
-                const std::string& dancer_email,
-                const std::string& dancer_house,
-                const std::string& dancer_team,
-                const std::string& dancer_role,
-                const std::string& dancer_id);
+                std::string donor_first_name, 
+                std::string donor_last_name,
+                std::string donor_email,
+                std::string donor_phone,
+                symbol_t donor_relation,
+                std::string dancer_name,
+                std::string dancer_email,
+                symbol_t dancer_house,
+                symbol_t dancer_team,
+                symbol_t dancer_role,
+                std::string dancer_id);
 
         //The donation timestamp
         date_time_t _M_timestamp;
@@ -125,17 +132,17 @@ namespace Fundraising::Analysis {
         //The donor's phone
         std::string _M_donor_phone;
         //The donor's relation 
-        std::string _M_donor_relation;
+        symbol_t _M_donor_relation;
         //The dancer's name
         std::string _M_dancer_name;
         //The dancer's email 
         std::string _M_dancer_email;
         //The dancer's house
-        std::string _M_dancer_house;
+        symbol_t _M_dancer_house;
         //The dancer's team
-        std::string _M_dancer_team;
+        symbol_t _M_dancer_team;
         //The dancer's type
-        std::string _M_dancer_role;
+        symbol_t _M_dancer_role;
         //The associated peer id 
         std::string _M_dancer_id;
     }; //! donation_t
@@ -164,7 +171,7 @@ namespace Fundraising::Analysis {
             const std::string& last_name,
             const std::string& email,
             const std::string& phone, 
-            const std::string& relation);
+            symbol_t relation);
         
         //The donor's name
         std::string _M_donor_first_name;
@@ -175,7 +182,7 @@ namespace Fundraising::Analysis {
         //The donor's phone 
         std::string _M_donor_phone;
         //The donor's relation 
-        std::string _M_donor_relation;
+        symbol_t _M_donor_relation;
         //The dotal amount the donor donated
         donation_val_t _M_donation_amt;
         //The total amount the donor was matched
@@ -209,9 +216,9 @@ namespace Fundraising::Analysis {
         dancer_t(const std::string& dancer_id,
             const std::string& name,
             const std::string& email,
-            const std::string& role,
-            const std::string& house, 
-            const std::string& team
+            symbol_t role,
+            symbol_t house, 
+            symbol_t team
             );
         dancer_t() = default;
         //The dancer's peer id
@@ -221,17 +228,18 @@ namespace Fundraising::Analysis {
         //The dancer's email
         std::string _M_dancer_email;
         //The dancer's role in DMUM
-        std::string _M_dancer_role;
+        symbol_t _M_dancer_role;
         //The dancer's house
-        std::string _M_dancer_house;
+        symbol_t _M_dancer_house;
         //The dancer's team/associate team
-        std::string _M_dancer_team;
+        symbol_t _M_dancer_team;
         //The amount the dancer raised
         donation_val_t _M_amt_raised;
         //The amount the dancer was matched
         donation_val_t _M_amt_matched;
-        //List of donors
-        std::vector<std::pair<donor_t, donation_val_t>> _M_donors;
+        //Amount matched on donations from each donor, keyed by the 
+        //donor's id in the matcher's donor registry
+        std::unordered_map<size_t, donation_val_t> _M_donors;
     }; //! dancer_t
 
     bool operator<(const dancer_t& lhs, const dancer_t& rhs);
@@ -259,8 +267,7 @@ namespace Fundraising
         {
             size_t operator()(const Fundraising::Analysis::date_time_t& dt) const
             {
-                std::string dt_string = static_cast<std::string>(dt);
-                return std::hash<std::string>{}(dt_string);
+                return std::hash<std::int64_t>{}(dt._M_seconds);
             }
         };
     } //! namespace std
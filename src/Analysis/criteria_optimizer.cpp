@@ -0,0 +1,146 @@
+#include "criteria_optimizer.h"
+#include "donor_registry.h"
+#include "matching.h"
+#include "round_cursor.h"
+#include "Utility/thread_pool.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+namespace Fundraising::Analysis
+{
+    match_evaluator::match_evaluator(const std::vector<donation_t>& donations)
+        : _M_entries(), _M_moves(), _M_num_dancers(0), _M_num_ledgers(0)
+    {
+        _M_entries.reserve(donations.size());
+        std::unordered_map<std::string, std::uint32_t> dancer_index;
+        std::vector<symbol_t> dancer_roles;
+        //Ledger entries, keyed by dancer and donor id, and the dancers
+        //each donor id has a ledger entry with
+        std::unordered_map<std::uint64_t, std::uint32_t> ledger_index;
+        std::vector<std::vector<std::uint32_t>> donor_dancers;
+        auto ledger = [&](std::uint32_t dancer, donor_registry::donor_id donor)
+        {
+            std::uint64_t key = (static_cast<std::uint64_t>(dancer) << 32) | donor;
+            auto [it, inserted] = ledger_index.try_emplace(key, static_cast<std::uint32_t>(ledger_index.size()));
+            if (inserted)
+                donor_dancers[donor].push_back(dancer);
+            return it->second;
+        };
+
+        //Follows matcher::add_donation(), recording the donor merges as
+        //moves between ledger entries
+        donor_registry donor_ids;
+        for (size_t i = 0; i < donations.size(); ++i)
+        {
+            const donation_t& donation = donations[i];
+            donor_registry::donor_id id = donor_ids.find_or_add(donation._M_donor_phone, donation._M_donor_email,
+                [&](donor_registry::donor_id into, donor_registry::donor_id from)
+                {
+                    for (std::uint32_t dancer: donor_dancers[from])
+                    {
+                        std::uint32_t from_ledger = ledger_index.at((static_cast<std::uint64_t>(dancer) << 32) | from);
+                        _M_moves.push_back({static_cast<std::uint32_t>(i), from_ledger, ledger(dancer, into)});
+                    }
+                    donor_dancers[from].clear();
+                });
+            if (id == donor_dancers.size())
+                donor_dancers.emplace_back();
+            //The matcher keeps the role a dancer's first donation gives
+            auto [d_it, new_dancer] = dancer_index.try_emplace(donation._M_dancer_id, static_cast<std::uint32_t>(dancer_roles.size()));
+            if (new_dancer)
+                dancer_roles.push_back(donation._M_dancer_role);
+            std::uint32_t dancer = d_it->second;
+            _M_entries.push_back({donation._M_timestamp, donation._M_amt, dancer_roles[dancer], dancer, ledger(dancer, id)});
+        }
+        _M_num_dancers = dancer_roles.size();
+        _M_num_ledgers = ledger_index.size();
+    } //! match_evaluator()
+
+    void match_evaluator::evaluate(const std::vector<matching_criterion_t>& rounds, workspace& ws, evaluation_t& result) const
+    {
+        ws._M_dancer_matched.assign(_M_num_dancers, ZERO);
+        ws._M_donor_matched.assign(_M_num_ledgers, ZERO);
+        result._M_total_matched = ZERO;
+        result._M_unused_general.clear();
+        result._M_unused_dancer.clear();
+
+        //Steps through the rounds like matcher::advance_matching_round()
+        round_cursor cursor(rounds.size());
+        matching_criterion_t curr = matcher::NO_MATCHING;
+        donation_val_t general_pool, dancer_pool;
+        auto change_pools = [&](round_cursor::change_t change)
+        {
+            matcher::change_matching_pools(change, cursor, rounds, curr, general_pool, dancer_pool, 
+                result._M_unused_general, result._M_unused_dancer);
+        };
+
+        size_t next_move = 0;
+        for (size_t i = 0; i < _M_entries.size(); ++i)
+        {
+            const entry_t& entry = _M_entries[i];
+            if (i == 0)
+                change_pools(cursor.start(rounds, entry._M_timestamp));
+            change_pools(cursor.advance(rounds, !matcher::is_no_matching(curr), entry._M_timestamp));
+            while (next_move < _M_moves.size() && _M_moves[next_move]._M_donation == i)
+            {
+                const ledger_move_t& move = _M_moves[next_move++];
+                ws._M_donor_matched[move._M_into] += ws._M_donor_matched[move._M_from];
+                ws._M_donor_matched[move._M_from] = ZERO;
+            }
+
+            donation_val_t& dancer_matched = ws._M_dancer_matched[entry._M_dancer];
+            donation_val_t& donor_matched = ws._M_donor_matched[entry._M_ledger];
+            donation_val_t matched_amt = matcher::settle_match(entry._M_role,
+                matcher::virtual_match(curr, entry._M_role, entry._M_amt, donor_matched, dancer_matched),
+                general_pool, dancer_pool);
+            dancer_matched += matched_amt;
+            donor_matched += matched_amt;
+            result._M_total_matched += matched_amt;
+        }
+        //Include what is left of the last round, like the matcher's getters
+        if (!matcher::is_no_matching(curr))
+        {
+            result._M_unused_general.emplace_back(curr._M_start, general_pool);
+            result._M_unused_dancer.emplace_back(curr._M_start, dancer_pool);
+        }
+    } //! evaluate()
+
+    size_t match_evaluator::size() const
+    {
+        return _M_entries.size();
+    } //! size()
+
+    std::vector<candidate_result_t> optimize_criteria(const match_evaluator& evaluator,
+        const std::vector<scenario_t>& candidates, donation_val_t target_unused)
+    {
+        std::vector<candidate_result_t> results(candidates.size());
+        //Candidates are handed out in chunks, each reusing one workspace
+        static constexpr size_t CANDIDATES_PER_CHUNK = 16;
+        size_t num_chunks = (candidates.size() + CANDIDATES_PER_CHUNK - 1)/CANDIDATES_PER_CHUNK;
+        Utility::parallel_for(num_chunks, [&](size_t chunk)
+        {
+            match_evaluator::workspace ws;
+            match_evaluator::evaluation_t evaluation;
+            size_t end = std::min(candidates.size(), (chunk + 1)*CANDIDATES_PER_CHUNK);
+            for (size_t c = chunk*CANDIDATES_PER_CHUNK; c < end; ++c)
+            {
+                evaluator.evaluate(candidates[c]._M_rounds, ws, evaluation);
+                candidate_result_t& result = results[c];
+                result._M_candidate = c;
+                result._M_total_matched = evaluation._M_total_matched;
+                result._M_unused_general = total_unused(evaluation._M_unused_general);
+                result._M_unused_dancer = total_unused(evaluation._M_unused_dancer);
+                donation_val_t unused = result._M_unused_general + result._M_unused_dancer;
+                result._M_distance = (unused > target_unused) ? unused - target_unused : target_unused - unused;
+            }
+        });
+        std::stable_sort(results.begin(), results.end(), [](const candidate_result_t& lhs, const candidate_result_t& rhs)
+        {
+            if (lhs._M_distance != rhs._M_distance)
+                return lhs._M_distance < rhs._M_distance;
+            return lhs._M_total_matched > rhs._M_total_matched;
+        });
+        return results;
+    } //! optimize_criteria()
+} //! namespace Fundraising::Analysis
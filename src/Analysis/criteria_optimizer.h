@@ -0,0 +1,107 @@
+#ifndef CRITERIA_OPTIMIZER_H
+#define CRITERIA_OPTIMIZER_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "basic_types.h"
+#include "matching_base.h"
+#include "scenarios.h"
+
+namespace Fundraising::Analysis
+{
+    //Re-matches one set of donations under many different criteria,
+    //giving the same matched totals and unused pools as a matcher.
+    //Everything that doesn't depend on the criteria, such as which
+    //donor and dancer each donation belongs to and when donors are
+    //merged, is worked out once up front. Each evaluation is then one
+    //scan over a compact table, reusing the same few arrays, with no
+    //hashing and no allocation once the workspace has grown.
+    class match_evaluator
+    {
+        public:
+            //What matching came to under one set of criteria
+            struct evaluation_t
+            {
+                donation_val_t _M_total_matched;
+                //Money left in the pools at the end of each round
+                std::vector<std::pair<date_time_t, donation_val_t>> _M_unused_general;
+                std::vector<std::pair<date_time_t, donation_val_t>> _M_unused_dancer;
+            };
+            //Arrays reused from one evaluation to the next. Each thread
+            //evaluating at the same time needs its own.
+            class workspace
+            {
+                private:
+                    friend class match_evaluator;
+                    std::vector<donation_val_t> _M_dancer_matched;
+                    std::vector<donation_val_t> _M_donor_matched;
+            }; //! workspace
+
+            //Creates an evaluator for a set of donations
+            //@param donations the donations, matched in the order given
+            explicit match_evaluator(const std::vector<donation_t>& donations);
+
+            //Matches the donations under a set of criteria
+            //@param rounds the matching rounds, latest first
+            //@param ws scratch space
+            //@param result set to the results, reusing its storage
+            void evaluate(const std::vector<matching_criterion_t>& rounds, workspace& ws, evaluation_t& result) const;
+
+            //Returns the number of donations
+            size_t size() const;
+        private:
+            //One donation, reduced to what matching needs
+            struct entry_t
+            {
+                date_time_t _M_timestamp;
+                donation_val_t _M_amt;
+                symbol_t _M_role;
+                std::uint32_t _M_dancer;
+                //The dancer's ledger entry for the donor
+                std::uint32_t _M_ledger;
+            };
+            //A donor merge moving one ledger entry into another, made
+            //just before a donation is matched
+            struct ledger_move_t
+            {
+                std::uint32_t _M_donation;
+                std::uint32_t _M_from;
+                std::uint32_t _M_into;
+            };
+        private:
+            std::vector<entry_t> _M_entries;
+            std::vector<ledger_move_t> _M_moves;
+            size_t _M_num_dancers;
+            size_t _M_num_ledgers;
+    }; //! match_evaluator
+
+    //How one candidate set of criteria did
+    struct candidate_result_t
+    {
+        //Index of the candidate
+        size_t _M_candidate;
+        donation_val_t _M_total_matched;
+        //Money left unused after the last round, see total_unused()
+        donation_val_t _M_unused_general;
+        donation_val_t _M_unused_dancer;
+        //How far the unused total is from the target
+        donation_val_t _M_distance;
+    };
+
+    //Evaluates candidate criteria and ranks them by how close the money
+    //left unused comes to a target. A target of zero looks for the
+    //criteria that use the pools the most. Candidates as close as each
+    //other are ranked by how much they match, then keep their order, so
+    //with a grid from make_scenario_grid() the smallest values that
+    //match the most come first.
+    //@param evaluator the donations to match
+    //@param candidates the criteria to try
+    //@param target_unused the amount to leave unused over all rounds
+    //@return a result for each candidate, best first
+    std::vector<candidate_result_t> optimize_criteria(const match_evaluator& evaluator,
+        const std::vector<scenario_t>& candidates, donation_val_t target_unused);
+} //! namespace Fundraising::Analysis
+
+#endif
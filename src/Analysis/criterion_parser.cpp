@@ -51,9 +51,8 @@ namespace Fundraising::Analysis
                 std::sregex_iterator rend;
                 if(it == rend)
                     throw std::runtime_error("Invalid matching criteria file 3");
-                std::tuple<int,int,int> end_date = parse_date(it->str());
-                std::tuple<int,int,int> start_date = parse_date(it->str());
-                start_ts._M_date = start_date;
+                auto [year, month, day] = parse_date(it->str());
+                start_ts.set_date(year, month, day);
             }
 
             //Parse end date of matching criterion
@@ -66,8 +65,8 @@ namespace Fundraising::Analysis
                 std::sregex_iterator rend;
                 if(it == rend)
                     throw std::runtime_error("Invalid matching criteria file 5");
-                std::tuple<int,short,short> end_date = parse_date(it->str());
-                end_ts._M_date = end_date;
+                auto [year, month, day] = parse_date(it->str());
+                end_ts.set_date(year, month, day);
             }
 
             //Parse start time of matching criterion 
@@ -80,8 +79,8 @@ namespace Fundraising::Analysis
                 std::sregex_iterator rend;
                 if(it == rend)
                     throw std::runtime_error("Invalid matching criteria file 7");
-                auto start_time = parse_time(it->str());
-                start_ts._M_time = start_time;
+                auto [hour, min, sec] = parse_time(it->str());
+                start_ts.set_time(hour, min, sec);
             }
 
             else if(find_ignore_case(line, "END TIME"))
@@ -93,8 +92,8 @@ namespace Fundraising::Analysis
                 std::sregex_iterator rend;
                 if(it == rend)
                     throw std::runtime_error("Invalid matching criteria file 9");
-                auto end_time = parse_time(it->str());
-                end_ts._M_time = end_time;
+                auto [hour, min, sec] = parse_time(it->str());
+                end_ts.set_time(hour, min, sec);
             }
 
             //Parse dancer amount 
@@ -182,11 +181,11 @@ namespace Fundraising::Analysis
                 //Handle defaults
                 //If no constraint is specified, assume unlimited
                 if(!seenMaxPerDancer)
-                    criterion._M_max_per_person = std::make_pair(std::numeric_limits<int>::max(), 0);
+                    criterion._M_max_per_person = money::from_dollars(std::numeric_limits<int>::max());
                 if(!seenMaxPerDonation)
-                    criterion._M_max_per_donation = std::make_pair(std::numeric_limits<int>::max(),0);
+                    criterion._M_max_per_donation = money::from_dollars(std::numeric_limits<int>::max());
                 if(!seenMaxPerDonor)
-                    criterion._M_max_per_donor = std::make_pair(std::numeric_limits<int>::max(), 0);
+                    criterion._M_max_per_donor = money::from_dollars(std::numeric_limits<int>::max());
                 criteria.push_back(criterion);
                 reset();
             }
@@ -280,7 +279,7 @@ namespace Fundraising::Analysis
             _M_out << "END DATE: " << end_ts.substr(0, space_idx) << "\n";
             _M_out << "END TIME: " << end_ts.substr(space_idx + 1) << "\n";
             _M_out << "DANCER MATCHING AMOUNT: " << c._M_dancer_amt << "\n";
-            _M_out << "GENERAL MATCHIG AMOUNT: " << c._M_general_amt << "\n";
+            _M_out << "GENERAL MATCHING AMOUNT: " << c._M_general_amt << "\n";
             _M_out << "MAX PER DONATION: " << c._M_max_per_donation << "\n";
             _M_out << "MAX PER DONOR: " << c._M_max_per_donor << "\n";
             _M_out << "MAX PER DANCER: " << c._M_max_per_person << "\n";
@@ -0,0 +1,153 @@
+#include "donor_registry.h"
+#include "File_IO/binary_io.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace Fundraising::Analysis
+{
+    donor_registry::donor_id donor_registry::find_or_add(std::string_view phone, std::string_view email, const merge_func& merge)
+    {
+        std::string phone_key = normalize_phone(phone);
+        std::string email_key = normalize_email(email);
+        donor_id by_phone = lookup(_M_by_phone, phone_key);
+        donor_id by_email = lookup(_M_by_email, email_key);
+
+        donor_id id;
+        if (by_phone == size() && by_email == size())
+        {
+            id = _M_parent.size();
+            _M_parent.push_back(id);
+        }
+        else if (by_phone == size() || by_email == size() || by_phone == by_email)
+        {
+            id = (by_phone == size()) ? by_email : by_phone;
+        }
+        else
+        {
+            //Both were seen, as two different donors, so merge them
+            //keeping the older id
+            id = std::min(by_phone, by_email);
+            donor_id other = std::max(by_phone, by_email);
+            merge(id, other);
+            _M_parent[other] = id;
+        }
+        if (!phone_key.empty())
+            _M_by_phone.try_emplace(std::move(phone_key), id);
+        if (!email_key.empty())
+            _M_by_email.try_emplace(std::move(email_key), id);
+        return id;
+    } //! find_or_add()
+
+    donor_registry::donor_id donor_registry::find(donor_id id)
+    {
+        donor_id root = id;
+        while (_M_parent[root] != root)
+            root = _M_parent[root];
+        //Point the whole path at the root so the next find is quick
+        while (_M_parent[id] != root)
+            id = std::exchange(_M_parent[id], root);
+        return root;
+    } //! find()
+
+    bool donor_registry::is_current(donor_id id) const
+    {
+        return _M_parent[id] == id;
+    } //! is_current()
+
+    donor_registry::donor_id donor_registry::lookup(const std::unordered_map<std::string, donor_id>& index, const std::string& key)
+    {
+        if (key.empty())
+            return size();
+        auto it = index.find(key);
+        return (it == index.end()) ? size() : find(it->second);
+    } //! lookup()
+
+    size_t donor_registry::size() const
+    {
+        return _M_parent.size();
+    } //! size()
+
+    void donor_registry::reserve(size_t num_donors)
+    {
+        _M_parent.reserve(num_donors);
+        _M_by_phone.reserve(num_donors);
+        _M_by_email.reserve(num_donors);
+    } //! reserve()
+
+    //Writes an index as its size followed by each key and id
+    static void save_index(IO::binary_writer& out, const std::unordered_map<std::string, donor_registry::donor_id>& index)
+    {
+        out.write<std::uint64_t>(index.size());
+        for (const auto& [key, id]: index)
+        {
+            out.write_string(key);
+            out.write<std::uint64_t>(id);
+        }
+    } //! save_index()
+
+    static void load_index(IO::binary_reader& in, std::unordered_map<std::string, donor_registry::donor_id>& index, size_t num_ids)
+    {
+        index.clear();
+        auto size = in.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < size; ++i)
+        {
+            std::string key = in.read_string();
+            auto id = in.read<std::uint64_t>();
+            if (id >= num_ids)
+                throw std::runtime_error("corrupt donor index");
+            index.emplace(std::move(key), id);
+        }
+    } //! load_index()
+
+    void donor_registry::save_state(IO::binary_writer& out) const
+    {
+        out.write<std::uint64_t>(_M_parent.size());
+        for (donor_id parent: _M_parent)
+            out.write<std::uint64_t>(parent);
+        save_index(out, _M_by_phone);
+        save_index(out, _M_by_email);
+    } //! save_state()
+
+    void donor_registry::load_state(IO::binary_reader& in)
+    {
+        auto size = in.read<std::uint64_t>();
+        auto parents = in.read_array<std::uint64_t>(size);
+        _M_parent.assign(parents.begin(), parents.end());
+        for (donor_id parent: _M_parent)
+        {
+            if (parent >= _M_parent.size())
+                throw std::runtime_error("corrupt donor ids");
+        }
+        load_index(in, _M_by_phone, _M_parent.size());
+        load_index(in, _M_by_email, _M_parent.size());
+    } //! load_state()
+
+    std::string donor_registry::normalize_phone(std::string_view phone)
+    {
+        std::string digits;
+        digits.reserve(phone.size());
+        for (char c: phone)
+        {
+            if (std::isdigit(static_cast<unsigned char>(c)))
+                digits.push_back(c);
+        }
+        if (digits.size() == 11 && digits.front() == '1')
+            digits.erase(0, 1);
+        return digits;
+    } //! normalize_phone()
+
+    std::string donor_registry::normalize_email(std::string_view email)
+    {
+        while (!email.empty() && std::isspace(static_cast<unsigned char>(email.front())))
+            email.remove_prefix(1);
+        while (!email.empty() && std::isspace(static_cast<unsigned char>(email.back())))
+            email.remove_suffix(1);
+        std::string key(email);
+        for (char& c: key)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return key;
+    } //! normalize_email()
+} //! namespace Fundraising::Analysis
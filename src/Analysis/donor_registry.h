@@ -0,0 +1,76 @@
+#ifndef DONOR_REGISTRY_H
+#define DONOR_REGISTRY_H 1
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Fundraising::IO
+{
+    class binary_writer;
+    class binary_reader;
+}
+
+namespace Fundraising::Analysis
+{
+    //Gives each donor a stable id, found from their phone or email in
+    //O(1) expected time. Phones and emails are normalized first, so
+    //"(555) 000-0153" and "555-000-0153" are the same donor, and empty
+    //values never link donors. When one donation links two donors that
+    //were seen separately, e.g. a known phone with a known email of
+    //someone else, the two are merged union-find style and the older
+    //id is kept.
+    class donor_registry
+    {
+        public:
+            typedef size_t donor_id;
+            //Called when two donors are merged, before the newer id stops
+            //being used.
+            //@param into the id that is kept
+            //@param from the id merged into it
+            typedef std::function<void(donor_id into, donor_id from)> merge_func;
+
+            //Returns the id of the donor with this phone or email, giving
+            //them a new id if neither has been seen before
+            //@param phone the donor's phone
+            //@param email the donor's email
+            //@param merge called for each pair of donors this links
+            //@return the donor's id. Ids are handed out from 0 in order
+            donor_id find_or_add(std::string_view phone, std::string_view email, const merge_func& merge);
+            //Returns the id a donor is now known by
+            //@param id any id handed out before
+            //@return the id it was merged into, or id if it was not
+            donor_id find(donor_id id);
+            //Returns whether an id is still in use, not merged into another
+            //@param id any id handed out before
+            bool is_current(donor_id id) const;
+            //Returns the number of ids handed out, including merged ones
+            size_t size() const;
+            //Sizes the indices for a number of donors
+            void reserve(size_t num_donors);
+            //Writes the ids and indices for a checkpoint
+            void save_state(IO::binary_writer& out) const;
+            //Replaces the ids and indices with ones written by save_state
+            void load_state(IO::binary_reader& in);
+
+            //Keeps only the digits of a phone, dropping a leading US
+            //country code
+            static std::string normalize_phone(std::string_view phone);
+            //Trims an email and makes it lower case
+            static std::string normalize_email(std::string_view email);
+        private:
+            //Looks up a key, returning the donor's current id or size()
+            //if it is not known
+            donor_id lookup(const std::unordered_map<std::string, donor_id>& index, const std::string& key);
+        private:
+            //Parent of each id, an id is current when it is its own parent
+            std::vector<donor_id> _M_parent;
+            std::unordered_map<std::string, donor_id> _M_by_phone;
+            std::unordered_map<std::string, donor_id> _M_by_email;
+    }; //! donor_registry
+} //! namespace Fundraising::Analysis
+
+#endif
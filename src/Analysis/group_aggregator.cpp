@@ -0,0 +1,53 @@
+#include "group_aggregator.h"
+#include "order_statistics.h"
+
+namespace Fundraising::Analysis
+{
+    group_aggregator::group_id group_aggregator::group(symbol_t name)
+    {
+        auto [it, inserted] = _M_ids.try_emplace(name, _M_groups.size());
+        if (inserted)
+            _M_groups.push_back({name, money(), {}});
+        return it->second;
+    } //! group()
+
+    void group_aggregator::add_member(group_id id, const money* value)
+    {
+        _M_groups[id]._M_members.push_back(value);
+    } //! add_member()
+
+    void group_aggregator::add(group_id id, money amt)
+    {
+        _M_groups[id]._M_total += amt;
+    } //! add()
+
+    size_t group_aggregator::size() const
+    {
+        return _M_groups.size();
+    } //! size()
+
+    symbol_t group_aggregator::name(group_id id) const
+    {
+        return _M_groups[id]._M_name;
+    } //! name()
+
+    money group_aggregator::total(group_id id) const
+    {
+        return _M_groups[id]._M_total;
+    } //! total()
+
+    size_t group_aggregator::num_members(group_id id) const
+    {
+        return _M_groups[id]._M_members.size();
+    } //! num_members()
+
+    std::vector<money> group_aggregator::quantiles(group_id id, const std::vector<double>& qs) const
+    {
+        const auto& members = _M_groups[id]._M_members;
+        std::vector<money> values;
+        values.reserve(members.size());
+        for (const money* value: members)
+            values.push_back(*value);
+        return order_statistics::select_quantiles(values, qs);
+    } //! quantiles()
+} //! namespace Fundraising::Analysis
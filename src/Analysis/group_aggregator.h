@@ -0,0 +1,63 @@
+#ifndef GROUP_AGGREGATOR_H
+#define GROUP_AGGREGATOR_H 1
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "money.h"
+#include "symbol_table.h"
+
+namespace Fundraising::Analysis
+{
+    //Running totals for named groups of members, such as the dancers
+    //in each role, house and team. Groups get dense ids the first time
+    //they are named. Members are added once and referred to by the
+    //address of their own running total, which must stay valid, so
+    //quantiles are worked out without copying member records.
+    class group_aggregator
+    {
+        public:
+            typedef size_t group_id;
+
+            //Returns the id of a group, adding it if it is new
+            //@param name the group's name
+            //@return the group's id. Ids are handed out from 0 in order
+            group_id group(symbol_t name);
+            //Adds a member to a group. Each member should only be added
+            //to a group once.
+            //@param id the group
+            //@param value the member's running total, read when medians are found
+            void add_member(group_id id, const money* value);
+            //Adds to a group's total
+            //@param id the group
+            //@param amt the amount to add
+            void add(group_id id, money amt);
+
+            //Returns the number of groups
+            size_t size() const;
+            //Returns the name of a group
+            symbol_t name(group_id id) const;
+            //Returns the total of a group
+            money total(group_id id) const;
+            //Returns the number of members of a group
+            size_t num_members(group_id id) const;
+            //Returns quantiles of the members' running totals, found by 
+            //selection in O(n) time per quantile
+            //@param id the group
+            //@param qs the quantiles, from 0 to 1
+            //@return the quantile for each entry of qs, zero for a group without members
+            std::vector<money> quantiles(group_id id, const std::vector<double>& qs) const;
+        private:
+            struct group_t
+            {
+                symbol_t _M_name;
+                money _M_total;
+                std::vector<const money*> _M_members;
+            };
+        private:
+            std::vector<group_t> _M_groups;
+            std::unordered_map<symbol_t, group_id> _M_ids;
+    }; //! group_aggregator
+} //! namespace Fundraising::Analysis
+
+#endif
@@ -0,0 +1,279 @@
+#include "matching.h"
+#include "File_IO/binary_io.h"
+#include <cstdint>
+#include <stdexcept>
+
+//Saving and restoring a matcher, so a live run can pick up where it
+//left off. Values are written one field at a time in a fixed order.
+//Counts come first, and a count that runs past the end of the state
+//makes the reader throw.
+namespace Fundraising::Analysis
+{
+    static void write_money(IO::binary_writer& out, money amt)
+    {
+        out.write<std::int64_t>(amt.cents());
+    } //! write_money()
+
+    static money read_money(IO::binary_reader& in)
+    {
+        return money::from_cents(in.read<std::int64_t>());
+    } //! read_money()
+
+    static void write_time(IO::binary_writer& out, const date_time_t& dt)
+    {
+        out.write<std::int64_t>(dt._M_seconds);
+    } //! write_time()
+
+    static date_time_t read_time(IO::binary_reader& in)
+    {
+        date_time_t dt;
+        dt._M_seconds = in.read<std::int64_t>();
+        return dt;
+    } //! read_time()
+
+    static void write_criterion(IO::binary_writer& out, const matching_criterion_t& criterion)
+    {
+        write_money(out, criterion._M_general_amt);
+        write_money(out, criterion._M_dancer_amt);
+        write_money(out, criterion._M_max_per_donor);
+        write_money(out, criterion._M_max_per_person);
+        write_money(out, criterion._M_max_per_donation);
+        write_time(out, criterion._M_start);
+        write_time(out, criterion._M_end);
+    } //! write_criterion()
+
+    static matching_criterion_t read_criterion(IO::binary_reader& in)
+    {
+        matching_criterion_t criterion;
+        criterion._M_general_amt = read_money(in);
+        criterion._M_dancer_amt = read_money(in);
+        criterion._M_max_per_donor = read_money(in);
+        criterion._M_max_per_person = read_money(in);
+        criterion._M_max_per_donation = read_money(in);
+        criterion._M_start = read_time(in);
+        criterion._M_end = read_time(in);
+        return criterion;
+    } //! read_criterion()
+
+    static void write_unused(IO::binary_writer& out, const std::vector<std::pair<date_time_t, donation_val_t>>& unused)
+    {
+        out.write<std::uint64_t>(unused.size());
+        for (const auto& [start, amt]: unused)
+        {
+            write_time(out, start);
+            write_money(out, amt);
+        }
+    } //! write_unused()
+
+    static std::vector<std::pair<date_time_t, donation_val_t>> read_unused(IO::binary_reader& in)
+    {
+        std::vector<std::pair<date_time_t, donation_val_t>> unused;
+        auto size = in.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < size; ++i)
+        {
+            date_time_t start = read_time(in);
+            unused.emplace_back(start, read_money(in));
+        }
+        return unused;
+    } //! read_unused()
+
+    static void write_strings(IO::binary_writer& out, const std::unordered_set<std::string>& strings)
+    {
+        out.write<std::uint64_t>(strings.size());
+        for (const std::string& str: strings)
+            out.write_string(str);
+    } //! write_strings()
+
+    static std::unordered_set<std::string> read_strings(IO::binary_reader& in)
+    {
+        std::unordered_set<std::string> strings;
+        auto size = in.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < size; ++i)
+            strings.insert(in.read_string());
+        return strings;
+    } //! read_strings()
+
+    static void write_donor(IO::binary_writer& out, const donor_t& donor)
+    {
+        out.write_string(donor._M_donor_first_name);
+        out.write_string(donor._M_donor_last_name);
+        out.write_string(donor._M_donor_email);
+        out.write_string(donor._M_donor_phone);
+        out.write_string(donor._M_donor_relation.str());
+        write_money(out, donor._M_donation_amt);
+        write_money(out, donor._M_matched_amt);
+        out.write<std::uint64_t>(donor._M_dancer_ids.size());
+        for (const auto& [role, dancer_ids]: donor._M_dancer_ids)
+        {
+            out.write_string(role);
+            write_strings(out, dancer_ids);
+        }
+    } //! write_donor()
+
+    static donor_t read_donor(IO::binary_reader& in)
+    {
+        std::string first_name = in.read_string();
+        std::string last_name = in.read_string();
+        std::string email = in.read_string();
+        std::string phone = in.read_string();
+        symbol_t relation(in.read_string());
+        donor_t donor(first_name, last_name, email, phone, relation);
+        donor._M_donation_amt = read_money(in);
+        donor._M_matched_amt = read_money(in);
+        auto num_roles = in.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < num_roles; ++i)
+        {
+            std::string role = in.read_string();
+            donor._M_dancer_ids[role] = read_strings(in);
+        }
+        return donor;
+    } //! read_donor()
+
+    void matcher::save_state(IO::binary_writer& out) const
+    {
+        //Where matching is up to
+        out.write<std::uint64_t>(_M_matching_rounds.size());
+        for (const auto& round: _M_matching_rounds)
+            write_criterion(out, round);
+        out.write<std::uint64_t>(_M_round_cursor.num_left());
+        out.write<std::uint8_t>(_M_round_cursor.started());
+        write_criterion(out, _M_curr_criterion);
+        write_money(out, _M_curr_general_matching_amt);
+        write_money(out, _M_curr_dancer_matching_amt);
+        write_money(out, _M_total_raised);
+        write_unused(out, _M_unused_general);
+        write_unused(out, _M_unused_dancer);
+
+        out.write<std::uint64_t>(_M_matching_info.size());
+        for (const auto& [id, dancer]: _M_matching_info)
+        {
+            out.write_string(dancer._M_dancer_id);
+            out.write_string(dancer._M_dancer_name);
+            out.write_string(dancer._M_dancer_email);
+            out.write_string(dancer._M_dancer_role.str());
+            out.write_string(dancer._M_dancer_house.str());
+            out.write_string(dancer._M_dancer_team.str());
+            write_money(out, dancer._M_amt_raised);
+            write_money(out, dancer._M_amt_matched);
+            out.write<std::uint64_t>(dancer._M_donors.size());
+            for (const auto& [donor, amt]: dancer._M_donors)
+            {
+                out.write<std::uint64_t>(donor);
+                write_money(out, amt);
+            }
+        }
+        //The groups' totals and members follow from the dancers, only
+        //the order they were first seen in is kept
+        out.write<std::uint64_t>(_M_dancer_groups.size());
+        for (size_t g = 0; g < _M_dancer_groups.size(); ++g)
+            out.write_string(_M_dancer_groups.name(g).str());
+
+        _M_donor_ids.save_state(out);
+        out.write<std::uint64_t>(_M_donor_records.size());
+        for (const auto& record: _M_donor_records)
+        {
+            write_donor(out, record._M_donor);
+            out.write<std::uint8_t>(record._M_alumnus.has_value());
+            if (record._M_alumnus)
+                write_donor(out, *record._M_alumnus);
+        }
+
+        out.write<std::uint64_t>(_M_donations_by_hours.size());
+        for (const auto& [hour, bucket]: _M_donations_by_hours)
+        {
+            write_time(out, hour);
+            write_money(out, bucket._M_total_raised);
+            out.write<std::uint64_t>(bucket._M_num_donations);
+            out.write<std::uint64_t>(bucket._M_num_alumni_donations);
+            bucket._M_amounts.save_state(out);
+            write_strings(out, bucket._M_donors);
+            write_strings(out, bucket._M_alumni_donors);
+        }
+    }
+
+    void matcher::load_state(IO::binary_reader& in)
+    {
+        _M_matching_rounds.clear();
+        auto num_rounds = in.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < num_rounds; ++i)
+            _M_matching_rounds.push_back(read_criterion(in));
+        auto num_left = in.read<std::uint64_t>();
+        if (num_left > _M_matching_rounds.size())
+            throw std::runtime_error("corrupt matching rounds");
+        bool started = in.read<std::uint8_t>() != 0;
+        _M_round_cursor = round_cursor(num_left, started);
+        _M_curr_criterion = read_criterion(in);
+        _M_curr_general_matching_amt = read_money(in);
+        _M_curr_dancer_matching_amt = read_money(in);
+        _M_total_raised = read_money(in);
+        _M_unused_general = read_unused(in);
+        _M_unused_dancer = read_unused(in);
+        if (_M_unused_general.size() != _M_unused_dancer.size())
+            throw std::runtime_error("corrupt matching rounds");
+
+        _M_matching_info.clear();
+        auto num_dancers = in.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < num_dancers; ++i)
+        {
+            std::string id = in.read_string();
+            std::string name = in.read_string();
+            std::string email = in.read_string();
+            symbol_t role(in.read_string());
+            symbol_t house(in.read_string());
+            symbol_t team(in.read_string());
+            auto [it, inserted] = _M_matching_info.try_emplace(id, id, name, email, role, house, team);
+            if (!inserted)
+                throw std::runtime_error("corrupt dancers");
+            dancer_t& dancer = it->second;
+            dancer._M_amt_raised = read_money(in);
+            dancer._M_amt_matched = read_money(in);
+            auto num_donors = in.read<std::uint64_t>();
+            for (std::uint64_t d = 0; d < num_donors; ++d)
+            {
+                auto donor = in.read<std::uint64_t>();
+                dancer._M_donors[donor] = read_money(in);
+            }
+        }
+        _M_dancer_groups = group_aggregator();
+        auto num_groups = in.read<std::uint64_t>();
+        for (std::uint64_t g = 0; g < num_groups; ++g)
+            _M_dancer_groups.group(symbol_t(in.read_string()));
+        for (const auto& [id, dancer]: _M_matching_info)
+            update_dancer_statistics(dancer, dancer._M_amt_raised, true);
+
+        _M_donor_ids.load_state(in);
+        _M_donor_records.clear();
+        auto num_records = in.read<std::uint64_t>();
+        if (num_records != _M_donor_ids.size())
+            throw std::runtime_error("corrupt donors");
+        for (std::uint64_t i = 0; i < num_records; ++i)
+        {
+            donor_t donor = read_donor(in);
+            std::optional<donor_t> alumnus;
+            if (in.read<std::uint8_t>() != 0)
+                alumnus = read_donor(in);
+            _M_donor_records.push_back({std::move(donor), std::move(alumnus)});
+        }
+
+        _M_donations_by_hours.clear();
+        auto num_hours = in.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < num_hours; ++i)
+        {
+            hour_bucket_t& bucket = _M_donations_by_hours[read_time(in)];
+            bucket._M_total_raised = read_money(in);
+            bucket._M_num_donations = in.read<std::uint64_t>();
+            bucket._M_num_alumni_donations = in.read<std::uint64_t>();
+            bucket._M_amounts.load_state(in);
+            bucket._M_donors = read_strings(in);
+            bucket._M_alumni_donors = read_strings(in);
+        }
+        //Left over from before, the getters rebuild them
+        _M_hour_statistics.clear();
+        _M_dancer_statistics.clear();
+        _M_group_quantiles.clear();
+        _M_stale_groups.assign(_M_dancer_groups.size(), true);
+        _M_donors.clear();
+        _M_alumni.clear();
+        _M_rebuild_donors = true;
+    }
+} //! namespace Fundraising::Analysis
@@ -1,11 +1,22 @@
 #include "matching.h"
+#include "Utility/thread_pool.h"
 #include <numeric>
+#include <limits>
 #include <algorithm>
 
 namespace Fundraising::Analysis
 {
+    //Rough shape of a Giving Tuesday export, used to size tables, see 
+    //also DONATIONS_PER_DANCER
+    static constexpr size_t DONATIONS_PER_DONOR = 2;
+    static constexpr size_t MAX_HOURS = 48;
+    //Marks a donor not yet in the donor lists
+    static constexpr size_t NO_SLOT = std::numeric_limits<size_t>::max();
+
     const matching_criterion_t matcher::NO_MATCHING = {ZERO, ZERO, ZERO, ZERO, ZERO, date_time_t(), date_time_t()};
 
+    const std::vector<double> matcher::QUANTILES = {0.5, 0.9, 0.99};
+
     bool matcher::is_no_matching(const matching_criterion_t& mc)
     {
         return mc._M_dancer_amt == ZERO && mc._M_general_amt == ZERO && mc._M_max_per_donation == ZERO
@@ -14,56 +25,99 @@ namespace Fundraising::Analysis
 
     matcher::matcher(const std::vector<donation_t>& donation_list, 
         const std::vector<matching_criterion_t>& matching_rounds)
-        : _M_donations(donation_list),
+        : _M_donations(std::make_shared<const std::vector<donation_t>>(donation_list)),
         _M_matching_rounds(matching_rounds),
+        _M_round_cursor(_M_matching_rounds.size()),
+        _M_curr_criterion(NO_MATCHING),
         _M_curr_general_matching_amt(),
         _M_curr_dancer_matching_amt(),
-        _M_dancers_by_type(),
+        _M_dancer_groups(),
         _M_matching_info(),
         _M_donors(),
         _M_alumni(),
         _M_hour_statistics(),
-        _M_dancer_statistics()
+        _M_dancer_statistics(),
+        _M_group_quantiles(),
+        _M_stale_groups(),
+        _M_stale_donor_ids(),
+        _M_donor_slots(),
+        _M_alumni_slots(),
+        _M_rebuild_donors(false)
         {
-            initialize_matching_pools();
+
         }
 
     matcher::matcher(std::vector<donation_t>&& donation_list, 
         std::vector<matching_criterion_t>&& matching_rounds)
-        : _M_donations(donation_list),
-        _M_matching_rounds(matching_rounds),
+        : _M_donations(std::make_shared<const std::vector<donation_t>>(std::move(donation_list))),
+        _M_matching_rounds(std::move(matching_rounds)),
+        _M_round_cursor(_M_matching_rounds.size()),
+        _M_curr_criterion(NO_MATCHING),
         _M_curr_general_matching_amt(),
         _M_curr_dancer_matching_amt(),
-        _M_dancers_by_type(),
+        _M_dancer_groups(),
         _M_matching_info(),
         _M_donors(),
         _M_alumni(),
         _M_hour_statistics(),
-        _M_dancer_statistics()
+        _M_dancer_statistics(),
+        _M_group_quantiles(),
+        _M_stale_groups(),
+        _M_stale_donor_ids(),
+        _M_donor_slots(),
+        _M_alumni_slots(),
+        _M_rebuild_donors(false)
         {
-            initialize_matching_pools();
+
         }
-    
-    void matcher::initialize_matching_pools()
-    {
-        if (_M_matching_rounds.empty())
+
+    matcher::matcher(std::shared_ptr<const std::vector<donation_t>> donation_list, 
+        const std::vector<matching_criterion_t>& matching_rounds)
+        : _M_donations(std::move(donation_list)),
+        _M_matching_rounds(matching_rounds),
+        _M_round_cursor(_M_matching_rounds.size()),
+        _M_curr_criterion(NO_MATCHING),
+        _M_curr_general_matching_amt(),
+        _M_curr_dancer_matching_amt(),
+        _M_dancer_groups(),
+        _M_matching_info(),
+        _M_donors(),
+        _M_alumni(),
+        _M_hour_statistics(),
+        _M_dancer_statistics(),
+        _M_group_quantiles(),
+        _M_stale_groups(),
+        _M_stale_donor_ids(),
+        _M_donor_slots(),
+        _M_alumni_slots(),
+        _M_rebuild_donors(false)
         {
-            zero_matching_pools();
-        } else {
-            auto timestamp = _M_donations.front()._M_timestamp;
-            auto start = _M_matching_rounds.back()._M_start;
-            if (timestamp < _M_matching_rounds.back()._M_start)
-            {
-               zero_matching_pools();
-            } else 
-            {
-                _M_curr_criterion = _M_matching_rounds.back();
-                _M_curr_general_matching_amt = _M_curr_criterion._M_general_amt;
-                _M_curr_dancer_matching_amt = _M_curr_criterion._M_dancer_amt;
-            }
+
         }
-    }
 
+    matcher::matcher(const std::vector<matching_criterion_t>& matching_rounds)
+        : _M_donations(std::make_shared<const std::vector<donation_t>>()),
+        _M_matching_rounds(matching_rounds),
+        _M_round_cursor(_M_matching_rounds.size()),
+        _M_curr_criterion(NO_MATCHING),
+        _M_curr_general_matching_amt(),
+        _M_curr_dancer_matching_amt(),
+        _M_dancer_groups(),
+        _M_matching_info(),
+        _M_donors(),
+        _M_alumni(),
+        _M_hour_statistics(),
+        _M_dancer_statistics(),
+        _M_group_quantiles(),
+        _M_stale_groups(),
+        _M_stale_donor_ids(),
+        _M_donor_slots(),
+        _M_alumni_slots(),
+        _M_rebuild_donors(false)
+        {
+
+        }
+    
     const std::unordered_map<std::string, dancer_t>& matcher::get_matching_information() const
     {
         return _M_matching_info;
@@ -71,177 +125,232 @@ namespace Fundraising::Analysis
 
     const std::unordered_map<std::string, dancer_statistics_row>& matcher::get_dancer_statistics() const
     {
+        generate_dancer_statistics();
         return _M_dancer_statistics;
     }
 
     const std::map<date_time_t, hour_statistics_row>& matcher::get_hourly_statistics() const
     {
+        generate_hour_statistics();
         return _M_hour_statistics;
     }
 
     const std::vector<donor_t>& matcher::get_donor_information() const
     {
+        generate_donor_information();
         return _M_donors;
     }
 
     const std::vector<donor_t>& matcher::get_alumni_donor_information() const 
     {
+        generate_donor_information();
         return _M_alumni;
     }
 
     std::vector<std::pair<date_time_t, donation_val_t>> matcher::get_general_matching_money_left() const
     {
-        return _M_unused_general;
+        //Include what is left of the round in progress
+        auto unused = _M_unused_general;
+        if (!is_no_matching(_M_curr_criterion))
+            unused.emplace_back(_M_curr_criterion._M_start, _M_curr_general_matching_amt);
+        return unused;
     }
 
     std::vector<std::pair<date_time_t, donation_val_t>> matcher::get_dancer_matching_money_left() const
     {
-        return _M_unused_dancer;
+        //Include what is left of the round in progress
+        auto unused = _M_unused_dancer;
+        if (!is_no_matching(_M_curr_criterion))
+            unused.emplace_back(_M_curr_criterion._M_start, _M_curr_dancer_matching_amt);
+        return unused;
+    }
+
+    void matcher::reserve(size_t num_donations)
+    {
+        //There can never be more dancers, donors or hours than donations, 
+        //but a typical dancer receives several donations and a typical 
+        //donor gives more than one
+        _M_matching_info.reserve(num_donations/DONATIONS_PER_DANCER + 1);
+        _M_donor_ids.reserve(num_donations/DONATIONS_PER_DONOR + 1);
+        _M_donor_records.reserve(num_donations/DONATIONS_PER_DONOR + 1);
+        _M_donations_by_hours.reserve(std::min(num_donations, MAX_HOURS));
     }
 
     void matcher::perform_matching_calculations()
     {
-        //Iterate through all donations
-        std::pair<decltype(_M_donations.begin()), decltype(_M_donations.end())> curr_hour_donations;
-        for (size_t i = 0; i < _M_donations.size(); ++i)
+        reserve(_M_donations->size());
+        if (!_M_round_cursor.started())
         {
-            donation_t donation = _M_donations[i];
-            date_time_t hour(donation._M_timestamp);
-            std::get<1>(hour._M_time) = 0;
-            std::get<2>(hour._M_time) = 0;
-            _M_donations_by_hours[hour].push_back(donation);
-            //Check to see if need to reset matching pools
-            //Not thrilled with this solution but whatever 
-            if(!_M_matching_rounds.empty())
-            {
-              if(!is_no_matching(_M_curr_criterion)) 
-              {
-                if(donation._M_timestamp > _M_curr_criterion._M_end)
-                    reset_matching_pools(donation._M_timestamp);
-              } 
-              else 
-              {
-                if(donation._M_timestamp >= _M_matching_rounds.back()._M_start)
-                    reset_matching_pools(donation._M_timestamp);
-              }
-            }
-            //Get dancer and donor info
-            dancer_t dancer;
-            auto d_it = _M_matching_info.find(donation._M_dancer_id);
-            if (d_it == _M_matching_info.end()){
-                dancer = {
-                    donation._M_dancer_id,
-                    donation._M_dancer_name,
-                    donation._M_dancer_email,
-                    donation._M_dancer_role,
-                    donation._M_dancer_house,
-                    donation._M_dancer_team
-                };
-            } else 
-            {
-                dancer = d_it->second;
-            }
-            donor_t donor(
-                donation._M_donor_first_name,
-                donation._M_donor_last_name,
-                donation._M_donor_email,
-                donation._M_donor_phone,
-                donation._M_donor_card,
-                donation._M_donor_relation
-            );
-            //Update amount raised 
-            _M_total_raised = _M_total_raised + donation._M_amt;
-            //Calculate matching 
-            donation_val_t donor_matched_amt = get_donation_info(dancer, donor);
-            std::string role = dancer._M_dancer_role;
-            donation_val_t matched_amt;
-            if (role == "Dancer") matched_amt =dancer_match(donation._M_amt, donor_matched_amt, dancer._M_amt_matched);
-            else if (role != "DMUM") matched_amt = steering_match(donation._M_amt, donor_matched_amt, dancer._M_amt_matched);
-            //Update dancer matching 
-            dancer._M_amt_matched = dancer._M_amt_matched + matched_amt;
-            dancer._M_amt_raised = dancer._M_amt_raised + donation._M_amt;
-            update_donation_info(dancer, donor, matched_amt);
-            //Update donor matching 
-            donor._M_matched_amt = donor._M_matched_amt + matched_amt;
-            donor._M_donation_amt = donor._M_donation_amt + donation._M_amt;
-            //Update statistics 
-            //Dancer mathing information for Finance 
-            _M_matching_info[dancer._M_dancer_id] = dancer;
-            //update dancer statistics 
-            update_dancer_statistics(dancer, donation._M_amt);
-            //Update donor statistics
-            auto donor_it = std::find(_M_donors.begin(), _M_donors.end(), donor);
-            if (donor_it == _M_donors.end())
-            {
-                if (dancer._M_dancer_role == "DMUM")
-                    donor._M_dancer_ids["DMUM"].insert(dancer._M_dancer_id);
-                else if (dancer._M_dancer_role == "Dancer")
-                    donor._M_dancer_ids["Dancer"].insert(dancer._M_dancer_id);
-                else
-                    donor._M_dancer_ids["Leadership"].insert(dancer._M_dancer_id);
-                _M_donors.push_back(donor);
-            } 
-            else 
-            {
-                donor_t& d = *donor_it;
-                d._M_donation_amt = d._M_donation_amt + donation._M_amt;
-                d._M_matched_amt = d._M_matched_amt + matched_amt;
-                if (dancer._M_dancer_role == "DMUM")
-                    d._M_dancer_ids["DMUM"].insert(dancer._M_dancer_id);
-                else if (dancer._M_dancer_role == "Dancer")
-                    d._M_dancer_ids["Dancer"].insert(dancer._M_dancer_id);
-                else
-                    d._M_dancer_ids["Leadership"].insert(dancer._M_dancer_id);
-            }
-            //Update alumni info
-            if(donor._M_donor_relation.find("DMUM Alumni") != std::string::npos)
+            match_in_parallel();
+        }
+        else 
+        {
+            //Carry on from donations already added one at a time
+            for (const auto& donation: *_M_donations)
+                add_donation(donation);
+        }
+        finish_matching();
+    }
+
+    donation_val_t matcher::add_donation(const donation_t& donation)
+    {
+        advance_matching_round(donation._M_timestamp);
+        date_time_t hour = donation._M_timestamp.truncate_to_hour();
+        add_to_hour_bucket(_M_donations_by_hours[hour], donation);
+        //Find the donor first, merging any donors this donation links 
+        //before the dancer is read
+        donor_registry::donor_id id = _M_donor_ids.find_or_add(donation._M_donor_phone, donation._M_donor_email, 
+            [this](donor_registry::donor_id into, donor_registry::donor_id from) {merge_donor_records(into, from);});
+        //Get dancer info, updated in place. References into 
+        //_M_matching_info stay valid as it grows.
+        auto [d_it, new_dancer] = _M_matching_info.try_emplace(donation._M_dancer_id);
+        dancer_t& dancer = d_it->second;
+        if (new_dancer)
+        {
+            dancer = {
+                donation._M_dancer_id,
+                donation._M_dancer_name,
+                donation._M_dancer_email,
+                donation._M_dancer_role,
+                donation._M_dancer_house,
+                donation._M_dancer_team
+            };
+        }
+        //Update amount raised 
+        _M_total_raised = _M_total_raised + donation._M_amt;
+        //Calculate matching 
+        donation_val_t donor_matched_amt = get_donation_info(dancer, id);
+        symbol_t role = dancer._M_dancer_role;
+        donation_val_t matched_amt = settle_match(role, 
+            virtual_match(_M_curr_criterion, role, donation._M_amt, donor_matched_amt, dancer._M_amt_matched));
+        //Update dancer matching 
+        dancer._M_amt_matched = dancer._M_amt_matched + matched_amt;
+        dancer._M_amt_raised = dancer._M_amt_raised + donation._M_amt;
+        update_donation_info(dancer, id, matched_amt);
+        //update dancer statistics 
+        update_dancer_statistics(dancer, donation._M_amt, new_dancer);
+        //Update donor statistics
+        //Donor details are only copied the first time a donor is seen
+        auto make_donor = [&donation]()
+        {
+            return donor_t(donation._M_donor_first_name, donation._M_donor_last_name, donation._M_donor_email, 
+                donation._M_donor_phone, donation._M_donor_relation);
+        };
+        if (id == _M_donor_records.size())
+            _M_donor_records.push_back({make_donor(), std::nullopt});
+        donor_record_t& record = _M_donor_records[id];
+        add_to_donor(record._M_donor, dancer, donation._M_amt, matched_amt);
+        //Update alumni info
+        if(donation._M_donor_relation.has_flag(ALUMNI_RELATION))
+        {
+            if (!record._M_alumnus)
+                record._M_alumnus = make_donor();
+            add_to_donor(*record._M_alumnus, dancer, donation._M_amt, matched_amt);
+        }
+        if (!record._M_stale)
+        {
+            record._M_stale = true;
+            _M_stale_donor_ids.push_back(id);
+        }
+        return matched_amt;
+    }
+
+    void matcher::advance_matching_round(const date_time_t& dt)
+    {
+        if (!_M_round_cursor.started())
+            change_matching_pools(_M_round_cursor.start(_M_matching_rounds, dt));
+        change_matching_pools(_M_round_cursor.advance(_M_matching_rounds, !is_no_matching(_M_curr_criterion), dt));
+    }
+
+    void matcher::add_to_hour_bucket(hour_bucket_t& bucket, const donation_t& donation)
+    {
+        bucket._M_total_raised = bucket._M_total_raised + donation._M_amt;
+        ++bucket._M_num_donations;
+        bucket._M_amounts.insert(donation._M_amt);
+        bucket._M_donors.insert(donation._M_donor_phone);
+        if (donation._M_donor_relation.has_flag(ALUMNI_RELATION)) 
+        {
+            ++bucket._M_num_alumni_donations;
+            bucket._M_alumni_donors.insert(donation._M_donor_phone);
+        }
+    }
+
+    void matcher::add_to_donor(donor_t& donor, const dancer_t& dancer, donation_val_t amt, donation_val_t matched_amt)
+    {
+        donor._M_donation_amt = donor._M_donation_amt + amt;
+        donor._M_matched_amt = donor._M_matched_amt + matched_amt;
+        if (dancer._M_dancer_role.has_flag(DMUM_ROLE))
+            donor._M_dancer_ids["DMUM"].insert(dancer._M_dancer_id);
+        else if (dancer._M_dancer_role.has_flag(DANCER_ROLE))
+            donor._M_dancer_ids["Dancer"].insert(dancer._M_dancer_id);
+        else
+            donor._M_dancer_ids["Leadership"].insert(dancer._M_dancer_id);
+    }
+
+    void matcher::merge_donor_records(donor_registry::donor_id into, donor_registry::donor_id from, bool merge_ledgers)
+    {
+        auto merge = [](donor_t& kept, donor_t& merged)
+        {
+            kept._M_donation_amt = kept._M_donation_amt + merged._M_donation_amt;
+            kept._M_matched_amt = kept._M_matched_amt + merged._M_matched_amt;
+            for (auto& [role, dancer_ids]: merged._M_dancer_ids)
+                kept._M_dancer_ids[role].insert(dancer_ids.begin(), dancer_ids.end());
+            merged._M_dancer_ids.clear();
+        };
+        donor_record_t& kept = _M_donor_records[into];
+        donor_record_t& merged = _M_donor_records[from];
+        _M_rebuild_donors = true;
+        //Move what the merged donor gave each dancer over to the kept id
+        if (merge_ledgers)
+        {
+            for (const auto& dancer_ids: merged._M_donor._M_dancer_ids)
             {
-                auto alumnus_it = std::find(_M_alumni.begin(), _M_alumni.end(), donor);
-                if (alumnus_it == _M_alumni.end())
-                {
-                     if (dancer._M_dancer_role == "DMUM")
-                        donor._M_dancer_ids["DMUM"].insert(dancer._M_dancer_id);
-                    else if (dancer._M_dancer_role == "Dancer")
-                        donor._M_dancer_ids["Dancer"].insert(dancer._M_dancer_id);
-                    else
-                        donor._M_dancer_ids["Leadership"].insert(dancer._M_dancer_id);
-                    _M_alumni.push_back(donor);
-                } 
-                else 
-                {
-                    donor_t& d = *alumnus_it;
-                     if (dancer._M_dancer_role == "DMUM")
-                        d._M_dancer_ids["DMUM"].insert(dancer._M_dancer_id);
-                    else if (dancer._M_dancer_role == "Dancer")
-                        d._M_dancer_ids["Dancer"].insert(dancer._M_dancer_id);
-                    else
-                        d._M_dancer_ids["Leadership"].insert(dancer._M_dancer_id);
-                    d._M_donation_amt = d._M_donation_amt + donation._M_amt;
-                    d._M_matched_amt = d._M_matched_amt + matched_amt;
-                }
+                for (const auto& dancer_id: dancer_ids.second)
+                    merge_ledger_entry(_M_matching_info.at(dancer_id), into, from);
             }
         }
-        //Record what is left
-        if (!is_no_matching(_M_curr_criterion)) 
+        merge(kept._M_donor, merged._M_donor);
+        if (merged._M_alumnus)
         {
-            _M_unused_general.emplace_back(_M_curr_criterion._M_start, _M_curr_general_matching_amt);
-            _M_unused_dancer.emplace_back(_M_curr_criterion._M_start, _M_curr_dancer_matching_amt);
+            if (kept._M_alumnus)
+                merge(*kept._M_alumnus, *merged._M_alumnus);
+            else
+                kept._M_alumnus = std::move(merged._M_alumnus);
+            merged._M_alumnus.reset();
         }
-        //Build statistics
+    }
+
+    void matcher::merge_ledger_entry(dancer_t& dancer, donor_registry::donor_id into, donor_registry::donor_id from)
+    {
+        auto it = dancer._M_donors.find(from);
+        if (it == dancer._M_donors.end())
+            return;
+        donation_val_t amt = it->second;
+        dancer._M_donors.erase(it);
+        update_donation_info(dancer, into, amt);
+    }
+
+    void matcher::finish_matching()
+    {
+        //What is left in the current round is reported by the getters, 
+        //so matching can continue after the statistics are built
         generate_dancer_statistics();
         generate_hour_statistics();
+        generate_donor_information();
     }
 
-    donation_val_t matcher::dancer_match(donation_val_t donation_amt, donation_val_t donor_matched_amt, donation_val_t dancer_matched_amt)
+    donation_val_t matcher::virtual_match(const matching_criterion_t& criterion, symbol_t role, donation_val_t donation_amt, 
+        donation_val_t donor_matched_amt, donation_val_t dancer_matched_amt)
     {
-        auto max_dancer_matching_amt = _M_curr_criterion._M_max_per_person;
-        auto max_per_donor = _M_curr_criterion._M_max_per_donor;
-        auto max_per_donation = _M_curr_criterion._M_max_per_donation;
+        //DMUM members aren't matched
+        if (role.has_flag(DMUM_ROLE)) return ZERO;
+        auto max_dancer_matching_amt = criterion._M_max_per_person;
+        auto max_per_donor = criterion._M_max_per_donor;
+        auto max_per_donation = criterion._M_max_per_donation;
 
         if (dancer_matched_amt >= max_dancer_matching_amt || donor_matched_amt >= max_per_donor) return ZERO;
         if (donation_amt > max_per_donation)
             donation_amt = max_per_donation;
-        donation_val_t matched_amt(0,0);
         donation_val_t virtual_matched_amt(0,0);
         //Calculate amount dancer could be matched
         if (dancer_matched_amt + donation_amt < max_dancer_matching_amt) { 
@@ -254,230 +363,253 @@ namespace Fundraising::Analysis
             if (virtual_matched_amt + donor_matched_amt >= max_per_donor)
                 virtual_matched_amt = max_per_donor - donor_matched_amt;
         }
+        return virtual_matched_amt;
+    }
+
+    donation_val_t matcher::settle_match(symbol_t role, donation_val_t virtual_matched_amt)
+    {
+        return settle_match(role, virtual_matched_amt, _M_curr_general_matching_amt, _M_curr_dancer_matching_amt);
+    }
+
+    donation_val_t matcher::settle_match(symbol_t role, donation_val_t virtual_matched_amt, 
+        donation_val_t& general_pool, donation_val_t& dancer_pool)
+    {
+        if (role.has_flag(DMUM_ROLE)) return ZERO;
+        donation_val_t matched_amt(0,0);
+        //Leadership is only matched from the general pool
+        if (!role.has_flag(DANCER_ROLE))
+        {
+            matched_amt = std::min(virtual_matched_amt, general_pool);
+            general_pool = general_pool - matched_amt;
+            return matched_amt;
+        }
         //Calculate amount dancer will be matched based on remaining funds
-        if (_M_curr_dancer_matching_amt >= virtual_matched_amt) 
+        if (dancer_pool >= virtual_matched_amt) 
         {
-            matched_amt = std::min(virtual_matched_amt, _M_curr_dancer_matching_amt);
-            _M_curr_dancer_matching_amt = _M_curr_dancer_matching_amt - matched_amt;
+            matched_amt = std::min(virtual_matched_amt, dancer_pool);
+            dancer_pool = dancer_pool - matched_amt;
         }
-        else if (_M_curr_dancer_matching_amt < virtual_matched_amt && _M_curr_dancer_matching_amt > ZERO)
+        else if (dancer_pool < virtual_matched_amt && dancer_pool > ZERO)
         {
-            donation_val_t dancer_pool_amt = _M_curr_dancer_matching_amt;
-            _M_curr_dancer_matching_amt = ZERO;
+            donation_val_t dancer_pool_amt = dancer_pool;
+            dancer_pool = ZERO;
             virtual_matched_amt = virtual_matched_amt - dancer_pool_amt;
-            donation_val_t general_pool_amt = std::min(virtual_matched_amt, _M_curr_general_matching_amt);
-            _M_curr_general_matching_amt = _M_curr_general_matching_amt - general_pool_amt;
+            donation_val_t general_pool_amt = std::min(virtual_matched_amt, general_pool);
+            general_pool = general_pool - general_pool_amt;
             matched_amt = general_pool_amt + dancer_pool_amt;
         } else {
-            matched_amt = std::min(virtual_matched_amt, _M_curr_general_matching_amt);
-            _M_curr_general_matching_amt = _M_curr_general_matching_amt - matched_amt;
+            matched_amt = std::min(virtual_matched_amt, general_pool);
+            general_pool = general_pool - matched_amt;
         }
         return matched_amt;
     }
 
-    donation_val_t matcher::steering_match(donation_val_t donation_amt, donation_val_t donor_matched_amt, donation_val_t steering_matched_amt)
+    void matcher::change_matching_pools(round_cursor::change_t change)
     {
-        auto max_dancer_matching_amt = _M_curr_criterion._M_max_per_person;
-        auto max_per_donor = _M_curr_criterion._M_max_per_donor;
-        auto max_per_donation = _M_curr_criterion._M_max_per_donation;
-
-        if (steering_matched_amt >= max_dancer_matching_amt || donor_matched_amt >= max_per_donor) return ZERO;
-        donation_val_t matched_amt;
-        donation_val_t virtual_matched_amt;
-        if (donation_amt > max_per_donation)
-            donation_amt = max_per_donation;
-        //Calculated amount dancer chould be matched 
-        if (steering_matched_amt + donation_amt < max_dancer_matching_amt) { 
-            if (donation_amt + donor_matched_amt < max_per_donor)
-                virtual_matched_amt = donation_amt;
-            else
-                virtual_matched_amt = max_per_donor - donor_matched_amt;
-        } else {
-            virtual_matched_amt = max_dancer_matching_amt - steering_matched_amt;
-            if (virtual_matched_amt + donor_matched_amt >= max_per_donor)
-                virtual_matched_amt = max_per_donor - donor_matched_amt;
-        }
-        matched_amt = std::min(virtual_matched_amt, _M_curr_general_matching_amt);
-        _M_curr_general_matching_amt = _M_curr_general_matching_amt - matched_amt;
-        return matched_amt;
+        change_matching_pools(change, _M_round_cursor, _M_matching_rounds, _M_curr_criterion, 
+            _M_curr_general_matching_amt, _M_curr_dancer_matching_amt, _M_unused_general, _M_unused_dancer);
     }
 
-    void matcher::reset_matching_pools(const date_time_t& dt)
+    void matcher::change_matching_pools(round_cursor::change_t change, const round_cursor& cursor, 
+        const std::vector<matching_criterion_t>& rounds, matching_criterion_t& curr, 
+        donation_val_t& general_pool, donation_val_t& dancer_pool, 
+        std::vector<std::pair<date_time_t, donation_val_t>>& unused_general, 
+        std::vector<std::pair<date_time_t, donation_val_t>>& unused_dancer)
     {
+        if (change == round_cursor::NO_CHANGE)
+            return;
         //Add to unused amounts
-        if (!is_no_matching(_M_curr_criterion)) 
+        if (!is_no_matching(curr)) 
         {
-            _M_unused_general.emplace_back(_M_curr_criterion._M_start, _M_curr_general_matching_amt);
-            _M_unused_dancer.emplace_back(_M_curr_criterion._M_start, _M_curr_dancer_matching_amt);
+            unused_general.emplace_back(curr._M_start, general_pool);
+            unused_dancer.emplace_back(curr._M_start, dancer_pool);
         }
-        if(!_M_matching_rounds.empty())
-        {
-            //Check if matching criterion immediately following current one 
-            if (dt > _M_matching_rounds.back()._M_end)
-            {
-                _M_matching_rounds.pop_back();
-                if (_M_matching_rounds.empty())
-                {
-                    zero_matching_pools();
-                    return;
-                }
-            }
-            if (dt >= _M_matching_rounds.back()._M_start)
-            {
-                _M_curr_criterion = _M_matching_rounds.back();
-                _M_curr_general_matching_amt = (_M_unused_general.empty()) ?  _M_curr_criterion._M_general_amt : _M_unused_general.back().second + _M_curr_criterion._M_general_amt;
-                _M_curr_dancer_matching_amt = (_M_unused_dancer.empty()) ? _M_curr_criterion._M_dancer_amt : _M_unused_dancer.back().second + _M_curr_criterion._M_dancer_amt;
-            } 
-            else //We're in between matching criteria 
-            {
-                zero_matching_pools();
-            }
-        } 
-        //Done with matching for duration of program
-        else 
+        if (change == round_cursor::ZERO_POOLS)
         {
-           zero_matching_pools();
+            curr = NO_MATCHING;
+            general_pool = ZERO;
+            dancer_pool = ZERO;
+            return;
         }
+        //What is left of the last round carries over into the new one
+        curr = cursor.round(rounds);
+        general_pool = (unused_general.empty()) ? curr._M_general_amt : unused_general.back().second + curr._M_general_amt;
+        dancer_pool = (unused_dancer.empty()) ? curr._M_dancer_amt : unused_dancer.back().second + curr._M_dancer_amt;
     }
 
-    void matcher::zero_matching_pools()
+    donation_val_t matcher::get_donation_info(const dancer_t& dancer, donor_registry::donor_id donor)
     {
-        _M_curr_criterion = NO_MATCHING;
-        _M_curr_general_matching_amt = ZERO;
-        _M_curr_dancer_matching_amt = ZERO;
+        auto it = dancer._M_donors.find(donor);
+        if (it == dancer._M_donors.end()) return ZERO;
+        return it->second;
     }
 
-    donation_val_t matcher::get_donation_info(const dancer_t& dancer, const donor_t& donor)
+    void matcher::update_donation_info(dancer_t& dancer, donor_registry::donor_id donor, donation_val_t amt)
     {
-         auto it = std::find_if(dancer._M_donors.begin(), dancer._M_donors.end(),
-            [&](const std::pair<donor_t, donation_val_t>& lhs) {return lhs.first == donor;});
-        if (it == dancer._M_donors.end()) return ZERO;
-        return it->second;
+        donation_val_t& donor_amt = dancer._M_donors[donor];
+        donor_amt = donor_amt + amt;
     }
 
-    void matcher::update_donation_info(dancer_t& dancer, const donor_t& donor, donation_val_t amt)
+    void matcher::update_dancer_statistics(const dancer_t& dancer, const donation_val_t& d, bool new_dancer)
     {
-        auto it = std::find_if(dancer._M_donors.begin(), dancer._M_donors.end(), 
-            [&](const std::pair<donor_t, donation_val_t>& lhs) {return lhs.first == donor;});
-        if (it == dancer._M_donors.end()) dancer._M_donors.emplace_back(donor, amt);
-        else 
+        symbol_t role = dancer._M_dancer_role;
+        if(role.has_flag(DMUM_ROLE)) return;
+        static const symbol_t LEADERSHIP("Leadership");
+        //Groups by role, house, leadership if needed and team. A dancer 
+        //only counts once in a group that two of these name.
+        std::array<group_aggregator::group_id, 4> groups;
+        size_t num_groups = 0;
+        auto add_group = [&](symbol_t name)
+        {
+            group_aggregator::group_id id = _M_dancer_groups.group(name);
+            if (std::find(groups.begin(), groups.begin() + num_groups, id) == groups.begin() + num_groups)
+                groups[num_groups++] = id;
+        };
+        add_group(role);
+        add_group(dancer._M_dancer_house);
+        if(!role.has_flag(DANCER_ROLE))
+            add_group(LEADERSHIP);
+        add_group(dancer._M_dancer_team);
+        if (_M_stale_groups.size() < _M_dancer_groups.size())
+            _M_stale_groups.resize(_M_dancer_groups.size(), true);
+        for (size_t i = 0; i < num_groups; ++i)
         {
-            donation_val_t donor_amt = it->second;
-            donor_amt = donor_amt + amt;
-            it->second = donor_amt;
+            _M_stale_groups[groups[i]] = true;
+            if (new_dancer)
+                _M_dancer_groups.add_member(groups[i], &dancer._M_amt_raised);
+            _M_dancer_groups.add(groups[i], d);
         }
     }
 
-    void matcher::update_dancer_statistics(const dancer_t& dancer, const donation_val_t& d)
+    void matcher::generate_dancer_statistics() const
     {
-        std::string role = dancer._M_dancer_role;
-        if(role == "DMUM") return;
-        //Update based on role
-        update_statistics_table(dancer, d, role);
-        //Update based on house 
-        std::string house = dancer._M_dancer_house;
-        update_statistics_table(dancer, d, house);
-        //Update leadership role is needed 
-        if(role != "Dancer")
+        //Only groups a donation went to since the last call need their 
+        //quantiles found again. Groups are independent, so do those 
+        //concurrently.
+        _M_group_quantiles.resize(_M_dancer_groups.size());
+        _M_stale_groups.resize(_M_dancer_groups.size(), true);
+        std::vector<group_aggregator::group_id> stale;
+        for (group_aggregator::group_id id = 0; id < _M_stale_groups.size(); ++id)
         {
-           update_statistics_table(dancer, d, "Leadership");
+            if (_M_stale_groups[id])
+                stale.push_back(id);
+            _M_stale_groups[id] = false;
+        }
+        Utility::parallel_for(stale.size(), [&](size_t i)
+        {
+            _M_group_quantiles[stale[i]] = _M_dancer_groups.quantiles(stale[i], QUANTILES);
+        });
+        //The percentages change with every donation, but are cheap
+        double total_participants = _M_matching_info.size();
+        double total_raised = _M_total_raised.to_double();
+        for (group_aggregator::group_id id = 0; id < _M_dancer_groups.size(); ++id)
+        {
+            donation_val_t total_donations = _M_dancer_groups.total(id);
+            size_t num_participants = _M_dancer_groups.num_members(id);
+            donation_val_t avg_donation = total_donations/num_participants;
+            const std::vector<donation_val_t>& quantiles = _M_group_quantiles[id];
+            double type_fundraising = total_donations.to_double();
+            double percent_of_total = type_fundraising/total_raised;
+            double percent_of_participants = num_participants/total_participants;
+            _M_dancer_statistics[_M_dancer_groups.name(id).str()] = std::make_tuple(total_donations, avg_donation, 
+                quantiles[0], quantiles[1], quantiles[2], percent_of_total, num_participants, percent_of_participants);
         }
-        //Update dancer team
-        update_statistics_table(dancer, d, dancer._M_dancer_team);
     }
 
-    void matcher::update_statistics_table(const dancer_t& dancer, const donation_val_t&d, const std::string& role)
+    void matcher::generate_hour_statistics() const
     {
-        auto it = _M_dancers_by_type.find(role);
-        if (it == _M_dancers_by_type.end())
+        //Rows already built from every donation in their hour are kept. 
+        //The rest are independent, so build them concurrently and store 
+        //them afterwards.
+        std::vector<std::pair<date_time_t, const hour_bucket_t*>> hours;
+        for (const auto& [hour, bucket]: _M_donations_by_hours)
         {
-            _M_dancers_by_type[role] = {dancer};
+            auto it = _M_hour_statistics.find(hour);
+            if (it == _M_hour_statistics.end() || std::get<5>(it->second) != bucket._M_num_donations)
+                hours.emplace_back(hour, &bucket);
         }
-        else 
+        std::vector<hour_statistics_row> rows(hours.size());
+        Utility::parallel_for(rows.size(), [&](size_t i)
         {
-            auto dancers_role_it = _M_dancers_by_type.find(role);
-            auto dancer_it = dancers_role_it->second.find(dancer);
-            if (dancer_it == dancers_role_it->second.end())
-            {
-                dancers_role_it->second.insert(dancer);
-            }
-            else 
-            {
-                dancers_role_it->second.erase(dancer_it);
-                dancers_role_it->second.insert(dancer);
-            }
-        }
+            const hour_bucket_t& bucket = *hours[i].second;
+            size_t num_donations = bucket._M_num_donations;
+            std::vector<donation_val_t> quantiles = bucket._M_amounts.quantiles(QUANTILES);
+            donation_val_t avg_donation = bucket._M_total_raised/num_donations;
+            rows[i] = std::make_tuple(bucket._M_total_raised, avg_donation, quantiles[0], quantiles[1], 
+                quantiles[2], num_donations, 
+                bucket._M_donors.size(), bucket._M_num_alumni_donations, bucket._M_alumni_donors.size());
+        });
+        for (size_t i = 0; i < rows.size(); ++i)
+            _M_hour_statistics.insert_or_assign(hours[i].first, rows[i]);
     }
 
-    void matcher::generate_dancer_statistics()
+    void matcher::generate_donor_information() const
     {
-        double total_participants = _M_matching_info.size();
-        double total_raised = _M_total_raised.first + _M_total_raised.second*0.01;
-        auto it1 = _M_dancers_by_type.begin();
-        while (it1 != _M_dancers_by_type.end())
+        //Only the donors given to since the last call are copied again. 
+        //Donors are listed in id order, so new ones go on the end.
+        if (_M_rebuild_donors)
+            return rebuild_donor_information();
+        std::sort(_M_stale_donor_ids.begin(), _M_stale_donor_ids.end());
+        _M_donor_slots.resize(_M_donor_records.size(), NO_SLOT);
+        _M_alumni_slots.resize(_M_donor_records.size(), NO_SLOT);
+        for (donor_registry::donor_id id: _M_stale_donor_ids)
         {
-            std::string role = it1->first;
-            auto dancer_set = it1->second;
-            donation_val_t total_donations = std::accumulate(dancer_set.begin(), dancer_set.end(), std::make_pair(0,0), 
-                [](const donation_val_t& lhs, const dancer_t& rhs) {return lhs + rhs._M_amt_raised;});
-            donation_val_t avg_donation = total_donations/dancer_set.size();
-            std::vector<donation_val_t> donation_list;
-            std::transform(dancer_set.begin(), dancer_set.end(), std::back_inserter(donation_list), [](const dancer_t& d)
+            const donor_record_t& record = _M_donor_records[id];
+            //A donor already listed who gives as an alumnus for the 
+            //first time would go in the middle of the alumni list
+            if (record._M_alumnus && _M_alumni_slots[id] == NO_SLOT && _M_donor_slots[id] != NO_SLOT)
+                return rebuild_donor_information();
+        }
+        for (donor_registry::donor_id id: _M_stale_donor_ids)
+        {
+            const donor_record_t& record = _M_donor_records[id];
+            record._M_stale = false;
+            if (_M_donor_slots[id] == NO_SLOT)
             {
-                return d._M_amt_raised;
-            });
-            std::sort(donation_list.begin(), donation_list.end());
-            donation_val_t median_donation;
-            if (donation_list.size() == 1)
-                median_donation = donation_list.front();
-            else if (donation_list.size() % 2 == 1) 
-                median_donation = donation_list[donation_list.size() / 2];
-            else 
-                median_donation = (donation_list[donation_list.size()/2 - 1] + donation_list[donation_list.size()/2])/2;
-            size_t num_participants = dancer_set.size();
-            double type_fundraising = total_donations.first + total_donations.second*0.01;
-            double percent_of_total = type_fundraising/total_raised;
-            double percent_of_participants = num_participants/total_participants;
-            _M_dancer_statistics[role] = std::make_tuple(total_donations, avg_donation, median_donation, 
-                percent_of_total, num_participants, percent_of_participants);
-            ++it1;
+                _M_donor_slots[id] = _M_donors.size();
+                _M_donors.push_back(record._M_donor);
+            }
+            else
+            {
+                _M_donors[_M_donor_slots[id]] = record._M_donor;
+            }
+            if (!record._M_alumnus)
+                continue;
+            if (_M_alumni_slots[id] == NO_SLOT)
+            {
+                _M_alumni_slots[id] = _M_alumni.size();
+                _M_alumni.push_back(*record._M_alumnus);
+            }
+            else
+            {
+                _M_alumni[_M_alumni_slots[id]] = *record._M_alumnus;
+            }
         }
+        _M_stale_donor_ids.clear();
     }
 
-    void matcher::generate_hour_statistics()
+    void matcher::rebuild_donor_information() const
     {
-        for(const auto& hour: _M_donations_by_hours)
+        //Donors merged into an older id are left out, the rest keep the 
+        //order they were first seen in
+        _M_donors.clear();
+        _M_alumni.clear();
+        _M_donor_slots.assign(_M_donor_records.size(), NO_SLOT);
+        _M_alumni_slots.assign(_M_donor_records.size(), NO_SLOT);
+        for (donor_registry::donor_id id = 0; id < _M_donor_records.size(); ++id)
         {
-            donation_val_t total_raised;
-            size_t num_donations = 0;
-            size_t num_alumni_donations = 0;
-            std::unordered_set<std::string> unique_donors;
-            std::unordered_set<std::string> unique_alumni_donors;
-            std::vector<donation_val_t> donation_list;
-            for(const auto& donation: hour.second)
+            _M_donor_records[id]._M_stale = false;
+            if (!_M_donor_ids.is_current(id))
+                continue;
+            _M_donor_slots[id] = _M_donors.size();
+            _M_donors.push_back(_M_donor_records[id]._M_donor);
+            if (_M_donor_records[id]._M_alumnus)
             {
-                total_raised = total_raised + donation._M_amt;
-                donation_list.push_back(donation._M_amt);
-                ++num_donations;
-                unique_donors.insert(donation._M_donor_phone);
-                if (donation._M_donor_relation.find("DMUM Alumni") != std::string::npos) 
-                {
-                    ++num_alumni_donations;
-                    unique_alumni_donors.insert(donation._M_donor_phone);
-                }
+                _M_alumni_slots[id] = _M_alumni.size();
+                _M_alumni.push_back(*_M_donor_records[id]._M_alumnus);
             }
-            std::sort(donation_list.begin(), donation_list.end());
-            donation_val_t median_donation;
-            if (donation_list.size() == 1)
-                median_donation = donation_list.front();
-            else if (donation_list.size() % 2 == 1) 
-                median_donation = donation_list[donation_list.size() / 2];
-            else 
-                median_donation = (donation_list[donation_list.size()/2 - 1] + donation_list[donation_list.size()/2])/2;
-            donation_val_t avg_donation = total_raised/num_donations;
-            _M_hour_statistics[hour.first] = std::make_tuple(total_raised, avg_donation, median_donation, num_donations, 
-                unique_donors.size(), num_alumni_donations, unique_alumni_donors.size());
         }
+        _M_stale_donor_ids.clear();
+        _M_rebuild_donors = false;
     }
-}
-
+}
\ No newline at end of file
@@ -1,26 +1,39 @@
 #ifndef MATCHING_HH
 #define MATCHING_HH 1
 
-#include <memory> //For unique_ptr
+#include <memory> //For unique_ptr, shared_ptr
 #include <deque>
 #include <vector>
 #include <map>
 #include <unordered_set>
 #include <array>
-#include <set>
+#include <optional>
 #include "basic_types.h"
+#include "donor_registry.h"
+#include "group_aggregator.h"
+#include "order_statistics.h"
 #include "matching_base.h"
+#include "round_cursor.h"
+
+namespace Fundraising::IO
+{
+    class binary_writer;
+    class binary_reader;
+}
 
 namespace Fundraising::Analysis 
 {
-    //Total Donations, Mean Donation, Median Donation,  % of Total Fundraising, Num Participants, % of Total Participants
-    typedef output_row_t<donation_val_t, donation_val_t, donation_val_t, double, size_t, double> dancer_statistics_row;
-    //Hourly fundraising, mean donation size, median donation size, num donors, num unique donors, number of alumni donors, 
-    //number of unique alumni donors
-    typedef output_row_t<donation_val_t, donation_val_t, donation_val_t, size_t, size_t, size_t, size_t> hour_statistics_row;
+    //Total Donations, Mean Donation, Median Donation, 90th Percentile, 99th Percentile, % of Total Fundraising, 
+    //Num Participants, % of Total Participants
+    typedef output_row_t<donation_val_t, donation_val_t, donation_val_t, donation_val_t, donation_val_t, double, size_t, double> dancer_statistics_row;
+    //Hourly fundraising, mean donation size, median donation size, 90th percentile, 99th percentile, num donors, 
+    //num unique donors, number of alumni donors, number of unique alumni donors
+    typedef output_row_t<donation_val_t, donation_val_t, donation_val_t, donation_val_t, donation_val_t, size_t, size_t, size_t, size_t> hour_statistics_row;
 
     class matcher
     {
+        //Shares the matching rules in virtual_match() and settle_match()
+        friend class match_evaluator;
         public:
         //Creates a new matcher with the specified list of donations 
         //and list of matching criteria. Note if the timestamp of the 
@@ -36,13 +49,63 @@ namespace Fundraising::Analysis
         matcher(std::vector<donation_t>&& donation_list, 
         std::vector<matching_criterion_t>&& matching_rounds);
 
+        //Creates a new matcher that reads a donation table shared with 
+        //other matchers, e.g. to try several sets of criteria on the 
+        //same donations. The table is never changed.
+        matcher(std::shared_ptr<const std::vector<donation_t>> donation_list, 
+        const std::vector<matching_criterion_t>& matching_rounds);
+
+        //Creates a new matcher with no donations for streaming use. Donations 
+        //are fed one at a time with add_donation in timestamp order and are 
+        //not kept, only the per-dancer, per-donor and per-hour totals are.
+        matcher(const std::vector<matching_criterion_t>& matching_rounds);
+
+        //Matchers can't be copied, as the dancer groups point into the 
+        //matcher's own dancers. Moving keeps the dancers where they are.
+        matcher(const matcher&) = delete;
+        matcher& operator=(const matcher&) = delete;
+        matcher(matcher&&) = default;
+        matcher& operator=(matcher&&) = default;
+
         //Calculates how much each dancer will be matched as well as 
         //all requested statistics about Giving Tuesday
         void perform_matching_calculations();
+        //Matches a single donation and adds it to the running totals. 
+        //Donations must be added in timestamp order. Takes amortized 
+        //constant time apart from a log of the number of distinct 
+        //donation sizes in the hour; the statistics are only marked 
+        //out of date, to be brought up to date by the getters.
+        //@param donation the next donation
+        //@return the amount the donation was matched
+        donation_val_t add_donation(const donation_t& donation);
+        //Brings the dancer and hourly statistics and the donor lists up 
+        //to date with the donations added so far. The getters do this 
+        //themselves, so this only does the work ahead of time.
+        void finish_matching();
+        //Writes everything worked out from the donations added so far, 
+        //but not the donations themselves, so the state grows with the 
+        //number of dancers, donors and hours rather than donations. 
+        //The statistics are left out as they are rebuilt from the totals.
+        //@param out where to write the state
+        void save_state(IO::binary_writer& out) const;
+        //Replaces the matcher's state with one written by save_state(). 
+        //Donations can then be added where the saved matcher left off. 
+        //Throws a std::runtime_error if the state is damaged.
+        //@param in the saved state
+        void load_state(IO::binary_reader& in);
+        //Sizes the matcher's tables ahead of time. Only a hint, any number 
+        //of donations may still be added.
+        //@param num_donations the expected number of donations
+        void reserve(size_t num_donations);
         //Returns the amount each dancer was matched
         //@return the amount each dancer was matched
         const std::unordered_map<std::string, dancer_t>& get_matching_information() const;
-        //Returns fundraising breakdown by dancer type (e.g. assorted vs fslr vs steering etc.)
+        //Returns fundraising breakdown by dancer type (e.g. assorted vs fslr vs steering etc.) 
+        //The statistics getters can be called at any time and bring what they 
+        //return up to date first, redoing only the groups, hours or donors 
+        //changed since the last call. The donor lists are rebuilt in full 
+        //after donors are merged or a listed donor first gives as an 
+        //alumnus. They must not be called from two threads at once.
         //@return fundraising breakdown by dancer type
         const std::unordered_map<std::string, dancer_statistics_row>& get_dancer_statistics() const;
         //Returns statistics broken down by hour 
@@ -61,77 +124,216 @@ namespace Fundraising::Analysis
         //@return amount of matching money unused. Entry element is the amount unused for that round 
         std::vector<std::pair<date_time_t, donation_val_t>> get_dancer_matching_money_left() const;
         private: //Helper functions 
-        //Calculates the amount that the dancer should be matched and subtracts from 
-        //the appropriate matching pool. 
-        //@param donation_amt the size of the donation_amt 
-        //@param donor_matched_amt the amount the donor has already donated to the dancer 
-        //@param dancer_matched_amt the amount the dancer has already been matched
-        //@return donation_amt the amount the dancer should be matched
-        donation_val_t dancer_match(donation_val_t donation_amt, donation_val_t donor_matched_amt, donation_val_t dancer_matched_amt);
-        //Calculates the amount that a steering member should be matched and subtracts from 
-        //the appropriate matching pool. 
-        //
-        //@param donation_amt the size of the donation_amt 
-        //@param donor_matched_amt the amount the donor has already donated to the dancer 
+        //Calculates the most a donation could be matched under a criterion, 
+        //going only on the dancer's and the donor's own history. The 
+        //matching pools are not looked at, so this can run for different 
+        //dancers at once.
+        //@param criterion the matching round the donation falls in
+        //@param role the dancer's role
+        //@param donation_amt the size of the donation
+        //@param donor_matched_amt the amount the donor's donations to the dancer have been matched
         //@param dancer_matched_amt the amount the dancer has already been matched
-        //@return donation_amt the amount the dancer should be matched
-        donation_val_t steering_match(donation_val_t donation_amt, donation_val_t donor_matched_amt, donation_val_t steering_matched_amt);
-        //Initializes the current matching criterion and matching pools based on the 
-        //timestamp of the first donation. Called wwhen the matcher object is 
-        //created. 
-        void initialize_matching_pools();
-        //Resets the matching pools with the current matchig criterion or 
-        //with the "NO_MATCHING" matching_criterion_t indicating that no 
-        //donations should be matched. 
-        void reset_matching_pools(const date_time_t& dt);
-        //Set matching pools so that no matching can happen
-        void zero_matching_pools();
+        //@return the amount the donation would be matched if the pools were large enough
+        static donation_val_t virtual_match(const matching_criterion_t& criterion, symbol_t role, donation_val_t donation_amt, 
+            donation_val_t donor_matched_amt, donation_val_t dancer_matched_amt);
+        //Takes the amount a donation is matched out of the matching pools. 
+        //Dancers draw on the dancer pool and then the general pool, 
+        //leadership only on the general pool. 
+        //@param role the dancer's role
+        //@param virtual_matched_amt the amount from virtual_match()
+        //@return the amount matched, less than virtual_matched_amt only when the pools run short
+        donation_val_t settle_match(symbol_t role, donation_val_t virtual_matched_amt);
+        //Takes the amount a donation is matched out of the given pools
+        //@param general_pool the general pool, reduced by what is taken from it
+        //@param dancer_pool the dancer pool, reduced by what is taken from it
+        static donation_val_t settle_match(symbol_t role, donation_val_t virtual_matched_amt, 
+            donation_val_t& general_pool, donation_val_t& dancer_pool);
+        //Moves on to the next matching round if a donation is past the current one 
+        //@param dt the timestamp of the next donation
+        void advance_matching_round(const date_time_t& dt);
+        //Refills the matching pools from the round the cursor entered, or 
+        //empties them, keeping what was left of the round in progress 
+        //@param change what round_cursor decided the donation does
+        void change_matching_pools(round_cursor::change_t change);
+        //Applies a change to the given round and pools
+        //@param cursor the cursor that decided the change
+        //@param rounds the matching rounds, latest first
+        //@param curr the round in progress, set to NO_MATCHING between rounds
+        //@param general_pool the general pool
+        //@param dancer_pool the dancer pool
+        //@param unused_general gains what was left of the general pool when a round ends
+        //@param unused_dancer gains what was left of the dancer pool when a round ends
+        static void change_matching_pools(round_cursor::change_t change, const round_cursor& cursor, 
+            const std::vector<matching_criterion_t>& rounds, matching_criterion_t& curr, 
+            donation_val_t& general_pool, donation_val_t& dancer_pool, 
+            std::vector<std::pair<date_time_t, donation_val_t>>& unused_general, 
+            std::vector<std::pair<date_time_t, donation_val_t>>& unused_dancer);
         //Returns the amount a donor has donated to the specified dancer 
         //
         //@param dancer the specified dancer 
-        //@param donor the specified donor
+        //@param donor the id of the specified donor
         //@return the amount a donor has specified to a particular dancer
-        donation_val_t get_donation_info(const dancer_t& dancer, const donor_t& donor);
+        donation_val_t get_donation_info(const dancer_t& dancer, donor_registry::donor_id donor);
         //Updates the amount the specified donor has donated to the dancer
         //@param dancer the specified dancer 
-        //@param donor the specified donor
+        //@param donor the id of the specified donor
         //@param amt the amount in the donation from the donor to the dancer
-        void update_donation_info(dancer_t& dancer, const donor_t& donor, donation_val_t amt);
+        void update_donation_info(dancer_t& dancer, donor_registry::donor_id donor, donation_val_t amt);
         //Updates the dancer statistics information with the dancers new fundraising total
         //@param dancer the dancer whose total will be used to update the fundraising statistics
         //@param d the donation used to update fundraising statistics
-        void update_dancer_statistics(const dancer_t& dancer, const donation_val_t& d);
-        //Insert the specified dancer and donation into the statistics table row for the specified role
-        //@param dancer the dancer whose total will be used to update the fundraising statistics
-        //@param d the donation used to update fundraising statistics
-        //@param role the dancer's row
-        void update_statistics_table(const dancer_t& dancer, const donation_val_t&d, const std::string& role);
-        //Will most likely needed functions to "build" dancer statistics and hourly statistics outputs
-        void generate_dancer_statistics();
-        void generate_hour_statistics();
+        //@param new_dancer whether this is the dancer's first donation
+        void update_dancer_statistics(const dancer_t& dancer, const donation_val_t& d, bool new_dancer);
+        //Adds a donation to a donor's totals 
+        //@param donor the donor to update
+        //@param dancer the dancer the donation was made to
+        //@param amt the size of the donation
+        //@param matched_amt the amount the donation was matched
+        static void add_to_donor(donor_t& donor, const dancer_t& dancer, donation_val_t amt, donation_val_t matched_amt);
+        //Moves the totals of a donor into another, found to be the same person
+        //@param into the id of the donor that is kept 
+        //@param from the id of the donor merged into it
+        //@param merge_ledgers whether to also combine the two in the dancers' ledgers
+        void merge_donor_records(donor_registry::donor_id into, donor_registry::donor_id from, bool merge_ledgers = true);
+        //Combines a dancer's ledger entries for two donors found to be the same person
+        //@param dancer the dancer whose ledger to update
+        //@param into the id of the donor that is kept 
+        //@param from the id of the donor merged into it
+        void merge_ledger_entry(dancer_t& dancer, donor_registry::donor_id into, donor_registry::donor_id from);
+        //Bring the statistics outputs up to date, redoing only what changed
+        void generate_dancer_statistics() const;
+        void generate_hour_statistics() const;
+        void generate_donor_information() const;
+        //Builds the donor lists from scratch
+        void rebuild_donor_information() const;
+        private:
+            //Running totals for the donations made in one hour 
+            struct hour_bucket_t
+            {
+                donation_val_t _M_total_raised;
+                size_t _M_num_donations = 0;
+                size_t _M_num_alumni_donations = 0;
+                //Donation sizes, kept for quantiles
+                order_statistics _M_amounts;
+                //Phone numbers of the donors 
+                std::unordered_set<std::string> _M_donors;
+                std::unordered_set<std::string> _M_alumni_donors;
+            };
+            //Running totals for one donor. Alumni totals only count 
+            //donations made as an alumnus.
+            struct donor_record_t
+            {
+                donor_t _M_donor;
+                std::optional<donor_t> _M_alumnus;
+                //Whether the id is waiting in _M_stale_donor_ids
+                mutable bool _M_stale = false;
+            };
+        private: //Parallel matching, see parallel_matching.cpp
+            //A donation from _M_donations after the bookkeeping pass
+            struct pending_match_t
+            {
+                donation_val_t _M_amt;
+                dancer_t* _M_dancer;
+                //Index of the dancer's dancer_work_t
+                size_t _M_work;
+                //The donor's id when the donation was made
+                donor_registry::donor_id _M_donor;
+                //Index of the matching round the donation falls in
+                size_t _M_criterion;
+                bool _M_alumnus;
+                //The amount virtual_match() gave, assuming every earlier 
+                //donation to the dancer was matched in full
+                donation_val_t _M_virtual_amt;
+            };
+            //Two donors merging, as seen by one dancer's ledger
+            struct ledger_merge_t
+            {
+                //The donation that linked the donors 
+                size_t _M_donation;
+                donor_registry::donor_id _M_into;
+                donor_registry::donor_id _M_from;
+            };
+            //The donations and donor merges for one dancer
+            struct dancer_work_t
+            {
+                dancer_t* _M_dancer;
+                std::vector<size_t> _M_donations;
+                std::vector<ledger_merge_t> _M_merges;
+                size_t _M_next_merge = 0;
+                //Number of the dancer's donations settled so far
+                size_t _M_num_settled = 0;
+                //Set once a pool ran short for this dancer, after which its 
+                //donations are matched one at a time
+                bool _M_diverged = false;
+            };
+        //Matches every donation in _M_donations, giving the same results as 
+        //calling add_donation() for each in turn. Each dancer's virtual 
+        //matched amounts are worked out in parallel, then a scan in 
+        //timestamp order settles them against the pools.
+        void match_in_parallel();
+        //Applies the donor merges a dancer's ledger sees up to a donation
+        //@param work the dancer
+        //@param donation the index of the donation, merges made by it are included
+        void apply_ledger_merges(dancer_work_t& work, size_t donation);
+        //Works out a dancer's virtual matched amounts from scratch, 
+        //assuming each was matched in full
+        //@param work the dancer
+        //@param pending all donations
+        //@param criteria the matching rounds the donations refer to
+        //@param count the number of the dancer's donations to go through
+        void speculate_dancer(dancer_work_t& work, std::vector<pending_match_t>& pending, 
+            const std::vector<matching_criterion_t>& criteria, size_t count);
+        //Adds a donation to an hour's totals
+        static void add_to_hour_bucket(hour_bucket_t& bucket, const donation_t& donation);
         private:
             static const matching_criterion_t NO_MATCHING;
+            //Rough number of donations a dancer receives, used to size 
+            //tables with an entry per dancer
+            static constexpr size_t DONATIONS_PER_DANCER = 8;
+            //Quantiles reported in the dancer and hourly statistics: the 
+            //median, 90th and 99th percentiles
+            static const std::vector<double> QUANTILES;
             static bool is_no_matching(const matching_criterion_t& mc);
         private:
-            //List of donations
-            std::vector<donation_t> _M_donations;
+            //List of donations, possibly shared with other matchers
+            std::shared_ptr<const std::vector<donation_t>> _M_donations;
             //Matching criteria 
             std::vector<matching_criterion_t> _M_matching_rounds;
+            //Where matching is up to in _M_matching_rounds
+            round_cursor _M_round_cursor;
             matching_criterion_t _M_curr_criterion;
             donation_val_t _M_curr_general_matching_amt;
             donation_val_t _M_curr_dancer_matching_amt;
             //Statistic keeping information 
             donation_val_t _M_total_raised;
-            std::unordered_map<date_time_t, std::vector<donation_t>> _M_donations_by_hours;
-            std::unordered_map<std::string, std::set<dancer_t>> _M_dancers_by_type;
+            std::unordered_map<date_time_t, hour_bucket_t> _M_donations_by_hours;
+            //Totals by role, house, team and "Leadership". Members are 
+            //the dancers' amounts raised in _M_matching_info.
+            group_aggregator _M_dancer_groups;
             std::vector<std::pair<date_time_t, donation_val_t>> _M_unused_general;
             std::vector<std::pair<date_time_t, donation_val_t>> _M_unused_dancer;
+            //Donor totals, indexed by the donor's id in _M_donor_ids
+            donor_registry _M_donor_ids;
+            std::vector<donor_record_t> _M_donor_records;
             //Outputs 
             std::unordered_map<std::string, dancer_t> _M_matching_info;
-            std::vector<donor_t> _M_donors;
-            std::vector<donor_t> _M_alumni;
-            std::map<date_time_t, hour_statistics_row> _M_hour_statistics;
-            std::unordered_map<std::string, dancer_statistics_row> _M_dancer_statistics;
+            //Built on demand by the getters
+            mutable std::vector<donor_t> _M_donors;
+            mutable std::vector<donor_t> _M_alumni;
+            mutable std::map<date_time_t, hour_statistics_row> _M_hour_statistics;
+            mutable std::unordered_map<std::string, dancer_statistics_row> _M_dancer_statistics;
+            //Quantiles of each group's members as of the last rebuild, and 
+            //which groups have changed since
+            mutable std::vector<std::vector<donation_val_t>> _M_group_quantiles;
+            mutable std::vector<char> _M_stale_groups;
+            //Donors added to since the donor lists were brought up to date, 
+            //and where each donor sits in the lists
+            mutable std::vector<donor_registry::donor_id> _M_stale_donor_ids;
+            mutable std::vector<size_t> _M_donor_slots;
+            mutable std::vector<size_t> _M_alumni_slots;
+            //Set when donors were merged or replaced, which the lists 
+            //can't be patched for
+            mutable bool _M_rebuild_donors;
 
 
     };
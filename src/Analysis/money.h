@@ -0,0 +1,94 @@
+#ifndef MONEY_H
+#define MONEY_H 1
+
+#include <cstdint>
+#include <type_traits>
+
+namespace Fundraising::Analysis
+{
+    //An exact amount of money, stored as a whole number of cents. 
+    //Arithmetic is plain integer arithmetic, so sums never drift and 
+    //there is no carry between dollars and cents to normalize.
+    class money
+    {
+        public:
+            //Creates $0.00
+            constexpr money() : _M_cents(0) {}
+            //Creates an amount from dollars and cents, e.g. money(20, 50) is $20.50
+            //@param dollars the whole dollars
+            //@param cents the cents to add to the dollars
+            constexpr money(std::int64_t dollars, std::int64_t cents) : _M_cents(dollars*100 + cents) {}
+
+            //Creates an amount from a number of cents
+            //@param cents the amount in cents
+            //@return the amount
+            static constexpr money from_cents(std::int64_t cents)
+            {
+                money m;
+                m._M_cents = cents;
+                return m;
+            } //! from_cents()
+            //Creates an amount from whole dollars
+            static constexpr money from_dollars(std::int64_t dollars)
+            {
+                return from_cents(dollars*100);
+            } //! from_dollars()
+
+            //Returns the amount in cents
+            constexpr std::int64_t cents() const {return _M_cents;}
+            //Returns the whole dollars in the amount, rounded toward zero
+            constexpr std::int64_t dollars() const {return _M_cents/100;}
+            //Returns the cents left over after the whole dollars, 0 to 99
+            constexpr std::int64_t cents_part() const {return (_M_cents < 0) ? -(_M_cents % 100) : _M_cents % 100;}
+            //Returns the amount in dollars, for ratios and percentages
+            constexpr double to_double() const {return static_cast<double>(_M_cents)/100.0;}
+
+            //Limits the amount to the range [lo, hi]
+            //@return the closest amount to this one in the range
+            constexpr money clamp(money lo, money hi) const
+            {
+                return (*this < lo) ? lo : (hi < *this) ? hi : *this;
+            } //! clamp()
+
+            constexpr money& operator+=(money rhs) {_M_cents += rhs._M_cents; return *this;}
+            constexpr money& operator-=(money rhs) {_M_cents -= rhs._M_cents; return *this;}
+            constexpr money operator-() const {return from_cents(-_M_cents);}
+
+            friend constexpr money operator+(money lhs, money rhs) {return from_cents(lhs._M_cents + rhs._M_cents);}
+            friend constexpr money operator-(money lhs, money rhs) {return from_cents(lhs._M_cents - rhs._M_cents);}
+            friend constexpr money operator*(money lhs, std::int64_t rhs) {return from_cents(lhs._M_cents*rhs);}
+
+            //Divides an amount into equal shares, rounded to the nearest 
+            //cent. Halves of a cent are rounded away from zero.
+            //@param lhs the amount to divide
+            //@param rhs the number of shares. Must not be zero
+            //@return the size of one share
+            template<typename _Tp, typename = std::enable_if_t<std::is_integral_v<_Tp>>>
+            friend constexpr money operator/(money lhs, _Tp rhs)
+            {
+                std::int64_t divisor = static_cast<std::int64_t>(rhs);
+                std::int64_t quotient = lhs._M_cents/divisor;
+                std::int64_t remainder = lhs._M_cents % divisor;
+                //Compare twice the remainder to the divisor without overflowing
+                std::int64_t abs_remainder = (remainder < 0) ? -remainder : remainder;
+                std::int64_t abs_divisor = (divisor < 0) ? -divisor : divisor;
+                if (abs_remainder >= abs_divisor - abs_remainder)
+                    quotient += ((lhs._M_cents < 0) == (divisor < 0)) ? 1 : -1;
+                return from_cents(quotient);
+            } //! operator/
+
+            friend constexpr bool operator==(money lhs, money rhs) {return lhs._M_cents == rhs._M_cents;}
+            friend constexpr bool operator!=(money lhs, money rhs) {return lhs._M_cents != rhs._M_cents;}
+            friend constexpr bool operator<(money lhs, money rhs) {return lhs._M_cents < rhs._M_cents;}
+            friend constexpr bool operator<=(money lhs, money rhs) {return lhs._M_cents <= rhs._M_cents;}
+            friend constexpr bool operator>(money lhs, money rhs) {return lhs._M_cents > rhs._M_cents;}
+            friend constexpr bool operator>=(money lhs, money rhs) {return lhs._M_cents >= rhs._M_cents;}
+        private:
+            std::int64_t _M_cents;
+    }; //! money
+
+    constexpr money min(money lhs, money rhs) {return (rhs < lhs) ? rhs : lhs;}
+    constexpr money max(money lhs, money rhs) {return (lhs < rhs) ? rhs : lhs;}
+} //! namespace Fundraising::Analysis
+
+#endif
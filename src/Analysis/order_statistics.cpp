@@ -0,0 +1,175 @@
+#include "order_statistics.h"
+#include "File_IO/binary_io.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace Fundraising::Analysis
+{
+    //Where a quantile falls among n sorted values
+    struct rank_t
+    {
+        size_t _M_lower;
+        size_t _M_upper;
+        //How far the quantile is from the lower rank to the upper one
+        double _M_fraction;
+    };
+
+    static rank_t rank_of(double q, size_t n)
+    {
+        q = std::clamp(q, 0.0, 1.0);
+        double position = q*static_cast<double>(n - 1);
+        size_t lower = static_cast<size_t>(std::floor(position));
+        double fraction = position - static_cast<double>(lower);
+        size_t upper = (fraction > 0 && lower + 1 < n) ? lower + 1 : lower;
+        return {lower, upper, fraction};
+    } //! rank_of()
+
+    static money interpolate(money lower, money upper, double fraction)
+    {
+        if (lower == upper)
+            return lower;
+        //Rounds half away from zero, so the mean of the middle two values
+        //rounds the same way as money's operator/
+        return lower + money::from_cents(std::llround(static_cast<double>((upper - lower).cents())*fraction));
+    } //! interpolate()
+
+    //Works out the ranks needed for a list of quantiles
+    //@param ranks set to where each quantile falls
+    //@return the distinct ranks needed, in increasing order
+    static std::vector<size_t> needed_ranks(const std::vector<double>& qs, size_t n, std::vector<rank_t>& ranks)
+    {
+        std::vector<size_t> needed;
+        ranks.clear();
+        for (double q: qs)
+        {
+            ranks.push_back(rank_of(q, n));
+            needed.push_back(ranks.back()._M_lower);
+            needed.push_back(ranks.back()._M_upper);
+        }
+        std::sort(needed.begin(), needed.end());
+        needed.erase(std::unique(needed.begin(), needed.end()), needed.end());
+        return needed;
+    } //! needed_ranks()
+
+    //Combines the values found at the needed ranks into the quantiles
+    static std::vector<money> combine(const std::vector<rank_t>& ranks, const std::vector<size_t>& needed,
+        const std::vector<money>& values)
+    {
+        auto value_at = [&](size_t rank)
+        {
+            return values[std::lower_bound(needed.begin(), needed.end(), rank) - needed.begin()];
+        };
+        std::vector<money> result;
+        result.reserve(ranks.size());
+        for (const rank_t& rank: ranks)
+            result.push_back(interpolate(value_at(rank._M_lower), value_at(rank._M_upper), rank._M_fraction));
+        return result;
+    } //! combine()
+
+    void order_statistics::insert(money value)
+    {
+        ++_M_counts[value];
+        ++_M_size;
+    } //! insert()
+
+    void order_statistics::erase(money value)
+    {
+        auto it = _M_counts.find(value);
+        if (it == _M_counts.end())
+            return;
+        if (--it->second == 0)
+            _M_counts.erase(it);
+        --_M_size;
+    } //! erase()
+
+    void order_statistics::replace(money old_value, money new_value)
+    {
+        if (old_value == new_value)
+            return;
+        erase(old_value);
+        insert(new_value);
+    } //! replace()
+
+    void order_statistics::save_state(IO::binary_writer& out) const
+    {
+        //Only the distinct values, in order
+        out.write<std::uint64_t>(_M_counts.size());
+        for (const auto& [value, count]: _M_counts)
+        {
+            out.write<std::int64_t>(value.cents());
+            out.write<std::uint64_t>(count);
+        }
+    } //! save_state()
+
+    void order_statistics::load_state(IO::binary_reader& in)
+    {
+        _M_counts.clear();
+        _M_size = 0;
+        auto num_values = in.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < num_values; ++i)
+        {
+            money value = money::from_cents(in.read<std::int64_t>());
+            auto count = in.read<std::uint64_t>();
+            if (count == 0)
+                throw std::runtime_error("corrupt amounts");
+            _M_counts.emplace_hint(_M_counts.end(), value, count);
+            _M_size += count;
+        }
+    } //! load_state()
+
+    size_t order_statistics::size() const
+    {
+        return _M_size;
+    } //! size()
+
+    bool order_statistics::empty() const
+    {
+        return _M_size == 0;
+    } //! empty()
+
+    money order_statistics::quantile(double q) const
+    {
+        return quantiles({q}).front();
+    } //! quantile()
+
+    std::vector<money> order_statistics::quantiles(const std::vector<double>& qs) const
+    {
+        if (_M_size == 0)
+            return std::vector<money>(qs.size());
+        std::vector<rank_t> ranks;
+        std::vector<size_t> needed = needed_ranks(qs, _M_size, ranks);
+        //Walk the distinct values in order, picking out the needed ranks
+        std::vector<money> values(needed.size());
+        size_t next = 0;
+        size_t seen = 0;
+        for (auto it = _M_counts.begin(); it != _M_counts.end() && next < needed.size(); ++it)
+        {
+            seen += it->second;
+            while (next < needed.size() && needed[next] < seen)
+                values[next++] = it->first;
+        }
+        return combine(ranks, needed, values);
+    } //! quantiles()
+
+    std::vector<money> order_statistics::select_quantiles(std::vector<money>& values, const std::vector<double>& qs)
+    {
+        if (values.empty())
+            return std::vector<money>(qs.size());
+        std::vector<rank_t> ranks;
+        std::vector<size_t> needed = needed_ranks(qs, values.size(), ranks);
+        //Each selection leaves everything after the chosen rank behind it,
+        //so the next, larger rank only needs to look there
+        std::vector<money> selected(needed.size());
+        auto begin = values.begin();
+        for (size_t i = 0; i < needed.size(); ++i)
+        {
+            auto nth = values.begin() + needed[i];
+            std::nth_element(begin, nth, values.end());
+            selected[i] = *nth;
+            begin = nth + 1;
+        }
+        return combine(ranks, needed, selected);
+    } //! select_quantiles()
+} //! namespace Fundraising::Analysis
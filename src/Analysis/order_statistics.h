@@ -0,0 +1,66 @@
+#ifndef ORDER_STATISTICS_H
+#define ORDER_STATISTICS_H 1
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include "money.h"
+
+namespace Fundraising::IO
+{
+    class binary_writer;
+    class binary_reader;
+}
+
+namespace Fundraising::Analysis
+{
+    //Exact quantiles of a changing multiset of amounts. Keeps a count of
+    //each distinct amount, so adding or removing a value is O(log d) and
+    //any number of quantiles are found in one walk over the d distinct
+    //values, without sorting. Donation sizes repeat a lot, so d is
+    //usually far smaller than the number of values.
+    //
+    //Quantiles interpolate between the two closest ranks, so the 0.5
+    //quantile of an even number of values is the mean of the middle two.
+    class order_statistics
+    {
+        public:
+            //Adds a value
+            void insert(money value);
+            //Removes one copy of a value, which must have been added
+            void erase(money value);
+            //Replaces one copy of a value with another
+            void replace(money old_value, money new_value);
+            //Writes the values for a checkpoint
+            void save_state(IO::binary_writer& out) const;
+            //Replaces the values with ones written by save_state
+            void load_state(IO::binary_reader& in);
+
+            //Returns the number of values
+            size_t size() const;
+            bool empty() const;
+
+            //Returns a quantile of the values
+            //@param q the quantile, from 0 to 1
+            //@return the quantile, or zero if there are no values
+            money quantile(double q) const;
+            //Returns several quantiles in one walk over the values
+            //@param qs the quantiles, from 0 to 1, in any order
+            //@return the quantile for each entry of qs
+            std::vector<money> quantiles(const std::vector<double>& qs) const;
+
+            //Finds quantiles of values that aren't kept in an
+            //order_statistics, in O(n) time per quantile by selection
+            //rather than sorting. Used when the values are only looked at
+            //once, such as at the end of a batch run.
+            //@param values the values, which are reordered
+            //@param qs the quantiles, from 0 to 1, in any order
+            //@return the quantile for each entry of qs, zero if values is empty
+            static std::vector<money> select_quantiles(std::vector<money>& values, const std::vector<double>& qs);
+        private:
+            std::map<money, size_t> _M_counts;
+            size_t _M_size = 0;
+    }; //! order_statistics
+} //! namespace Fundraising::Analysis
+
+#endif
@@ -0,0 +1,203 @@
+#include "matching.h"
+#include "Utility/thread_pool.h"
+#include <limits>
+
+//Matching in two phases. How much a donation could be matched depends
+//only on the dancer's and the donor's own history under the round's
+//caps, see virtual_match(). Only taking the money out of the pools has
+//to happen in timestamp order, see settle_match(). So the virtual amounts
+//are worked out for each dancer in parallel, assuming each donation is
+//matched in full, and one scan in timestamp order settles them.
+//
+//While the pools last, every donation is matched in full and the
+//assumption holds. When a pool runs short for a donation, that dancer's
+//later virtual amounts are wrong, so the dancer is rebuilt up to that
+//donation and matched one donation at a time from then on. Other dancers
+//are not affected, so the results are exactly those of add_donation().
+namespace Fundraising::Analysis
+{
+    void matcher::match_in_parallel()
+    {
+        const std::vector<donation_t>& donations = *_M_donations;
+        size_t num_donations = donations.size();
+        std::vector<pending_match_t> pending;
+        pending.reserve(num_donations);
+        std::vector<dancer_work_t> work;
+        std::unordered_map<const dancer_t*, size_t> work_index;
+        work_index.reserve(num_donations/DONATIONS_PER_DANCER + 1);
+        //Donations in each hour, so the hour buckets can be filled in parallel
+        std::vector<std::pair<hour_bucket_t*, std::vector<size_t>>> hours;
+        std::unordered_map<date_time_t, size_t> hour_index;
+
+        //The rounds the donations fall in. Which round a donation is in
+        //depends only on the timestamps, so this follows
+        //advance_matching_round() without the pools.
+        round_cursor cursor(_M_matching_rounds.size());
+        std::vector<matching_criterion_t> criteria;
+        auto change_round = [&](round_cursor::change_t change)
+        {
+            if (change == round_cursor::ENTER_ROUND)
+                criteria.push_back(cursor.round(_M_matching_rounds));
+            else if (change == round_cursor::ZERO_POOLS)
+                criteria.push_back(NO_MATCHING);
+        };
+
+        //First pass: everything that doesn't depend on the pools, in order
+        for (size_t i = 0; i < num_donations; ++i)
+        {
+            const donation_t& donation = donations[i];
+            const date_time_t& dt = donation._M_timestamp;
+            if (i == 0)
+                change_round(cursor.start(_M_matching_rounds, dt));
+            change_round(cursor.advance(_M_matching_rounds, !is_no_matching(criteria.back()), dt));
+
+            auto [h_it, new_hour] = hour_index.try_emplace(dt.truncate_to_hour(), hours.size());
+            if (new_hour)
+                hours.emplace_back(&_M_donations_by_hours[h_it->first], std::vector<size_t>());
+            hours[h_it->second].second.push_back(i);
+
+            //Donor merges are recorded for the ledgers of the dancers the
+            //merged donor gave to, and applied to them in the second pass
+            donor_registry::donor_id id = _M_donor_ids.find_or_add(donation._M_donor_phone, donation._M_donor_email,
+                [&](donor_registry::donor_id into, donor_registry::donor_id from)
+                {
+                    for (const auto& dancer_ids: _M_donor_records[from]._M_donor._M_dancer_ids)
+                    {
+                        for (const auto& dancer_id: dancer_ids.second)
+                        {
+                            size_t w = work_index.at(&_M_matching_info.at(dancer_id));
+                            work[w]._M_merges.push_back({i, into, from});
+                        }
+                    }
+                    merge_donor_records(into, from, false);
+                });
+
+            auto [d_it, new_dancer] = _M_matching_info.try_emplace(donation._M_dancer_id);
+            dancer_t& dancer = d_it->second;
+            if (new_dancer)
+            {
+                dancer = {
+                    donation._M_dancer_id,
+                    donation._M_dancer_name,
+                    donation._M_dancer_email,
+                    donation._M_dancer_role,
+                    donation._M_dancer_house,
+                    donation._M_dancer_team
+                };
+                work_index.emplace(&dancer, work.size());
+                work.push_back({&dancer, {}, {}});
+            }
+            size_t w = work_index.at(&dancer);
+            work[w]._M_donations.push_back(i);
+            _M_total_raised = _M_total_raised + donation._M_amt;
+            dancer._M_amt_raised = dancer._M_amt_raised + donation._M_amt;
+            update_dancer_statistics(dancer, donation._M_amt, new_dancer);
+
+            //Matched amounts are added in the settlement scan
+            auto make_donor = [&donation]()
+            {
+                return donor_t(donation._M_donor_first_name, donation._M_donor_last_name, donation._M_donor_email,
+                    donation._M_donor_phone, donation._M_donor_relation);
+            };
+            if (id == _M_donor_records.size())
+                _M_donor_records.push_back({make_donor(), std::nullopt});
+            donor_record_t& record = _M_donor_records[id];
+            add_to_donor(record._M_donor, dancer, donation._M_amt, ZERO);
+            bool alumnus = donation._M_donor_relation.has_flag(ALUMNI_RELATION);
+            if (alumnus)
+            {
+                if (!record._M_alumnus)
+                    record._M_alumnus = make_donor();
+                add_to_donor(*record._M_alumnus, dancer, donation._M_amt, ZERO);
+            }
+            pending.push_back({donation._M_amt, &dancer, w, id, criteria.size() - 1, alumnus, ZERO});
+        }
+
+        //Second pass: hour buckets and each dancer's virtual amounts, in parallel
+        Utility::parallel_for(hours.size(), [&](size_t h)
+        {
+            for (size_t i: hours[h].second)
+                add_to_hour_bucket(*hours[h].first, donations[i]);
+        });
+        Utility::parallel_for(work.size(), [&](size_t w)
+        {
+            speculate_dancer(work[w], pending, criteria, work[w]._M_donations.size());
+            apply_ledger_merges(work[w], std::numeric_limits<size_t>::max());
+        });
+
+        //Third pass: settle against the pools in timestamp order
+        for (size_t i = 0; i < num_donations; ++i)
+        {
+            pending_match_t& p = pending[i];
+            dancer_work_t& w = work[p._M_work];
+            dancer_t& dancer = *p._M_dancer;
+            symbol_t role = dancer._M_dancer_role;
+            advance_matching_round(donations[i]._M_timestamp);
+            donation_val_t matched_amt;
+            if (!w._M_diverged)
+            {
+                matched_amt = settle_match(role, p._M_virtual_amt);
+                if (matched_amt != p._M_virtual_amt)
+                {
+                    //The pools ran short, rebuild the dancer up to here
+                    //and match the rest of its donations one at a time
+                    speculate_dancer(w, pending, criteria, w._M_num_settled);
+                    w._M_diverged = true;
+                }
+            }
+            else
+            {
+                apply_ledger_merges(w, i);
+                matched_amt = settle_match(role, virtual_match(_M_curr_criterion, role, p._M_amt,
+                    get_donation_info(dancer, p._M_donor), dancer._M_amt_matched));
+            }
+            if (w._M_diverged)
+            {
+                apply_ledger_merges(w, i);
+                dancer._M_amt_matched = dancer._M_amt_matched + matched_amt;
+                update_donation_info(dancer, p._M_donor, matched_amt);
+            }
+            ++w._M_num_settled;
+
+            donor_record_t& record = _M_donor_records[_M_donor_ids.find(p._M_donor)];
+            record._M_donor._M_matched_amt = record._M_donor._M_matched_amt + matched_amt;
+            if (p._M_alumnus)
+                record._M_alumnus->_M_matched_amt = record._M_alumnus->_M_matched_amt + matched_amt;
+        }
+        for (dancer_work_t& w: work)
+        {
+            if (w._M_diverged)
+                apply_ledger_merges(w, std::numeric_limits<size_t>::max());
+        }
+        _M_rebuild_donors = true;
+    }
+
+    void matcher::apply_ledger_merges(dancer_work_t& work, size_t donation)
+    {
+        while (work._M_next_merge < work._M_merges.size() && work._M_merges[work._M_next_merge]._M_donation <= donation)
+        {
+            const ledger_merge_t& merge = work._M_merges[work._M_next_merge++];
+            merge_ledger_entry(*work._M_dancer, merge._M_into, merge._M_from);
+        }
+    }
+
+    void matcher::speculate_dancer(dancer_work_t& work, std::vector<pending_match_t>& pending,
+        const std::vector<matching_criterion_t>& criteria, size_t count)
+    {
+        dancer_t& dancer = *work._M_dancer;
+        dancer._M_amt_matched = ZERO;
+        dancer._M_donors.clear();
+        work._M_next_merge = 0;
+        symbol_t role = dancer._M_dancer_role;
+        for (size_t k = 0; k < count; ++k)
+        {
+            size_t i = work._M_donations[k];
+            apply_ledger_merges(work, i);
+            pending_match_t& p = pending[i];
+            p._M_virtual_amt = virtual_match(criteria[p._M_criterion], role, p._M_amt,
+                get_donation_info(dancer, p._M_donor), dancer._M_amt_matched);
+            dancer._M_amt_matched = dancer._M_amt_matched + p._M_virtual_amt;
+            update_donation_info(dancer, p._M_donor, p._M_virtual_amt);
+        }
+    }
+} //! namespace Fundraising::Analysis
@@ -0,0 +1,53 @@
+#include "round_cursor.h"
+
+namespace Fundraising::Analysis
+{
+    round_cursor::round_cursor(size_t num_rounds)
+        : _M_num_left(num_rounds), _M_started(false)
+    {
+    } //! round_cursor()
+
+    round_cursor::round_cursor(size_t num_left, bool started)
+        : _M_num_left(num_left), _M_started(started)
+    {
+    } //! round_cursor()
+
+    round_cursor::change_t round_cursor::start(const std::vector<matching_criterion_t>& rounds, const date_time_t& dt)
+    {
+        _M_started = true;
+        if (_M_num_left == 0 || dt < rounds[_M_num_left - 1]._M_start)
+            return ZERO_POOLS;
+        return ENTER_ROUND;
+    } //! start()
+
+    round_cursor::change_t round_cursor::advance(const std::vector<matching_criterion_t>& rounds, bool in_round, 
+        const date_time_t& dt)
+    {
+        if (_M_num_left == 0)
+            return NO_CHANGE;
+        //A round ends once a donation is past it, a gap between rounds 
+        //once a donation reaches the next round
+        const matching_criterion_t& curr = rounds[_M_num_left - 1];
+        if (in_round ? dt <= curr._M_end : dt < curr._M_start)
+            return NO_CHANGE;
+        //Only one round is passed per donation
+        if (dt > curr._M_end && --_M_num_left == 0)
+            return ZERO_POOLS;
+        return (dt >= rounds[_M_num_left - 1]._M_start) ? ENTER_ROUND : ZERO_POOLS;
+    } //! advance()
+
+    const matching_criterion_t& round_cursor::round(const std::vector<matching_criterion_t>& rounds) const
+    {
+        return rounds[_M_num_left - 1];
+    } //! round()
+
+    size_t round_cursor::num_left() const
+    {
+        return _M_num_left;
+    } //! num_left()
+
+    bool round_cursor::started() const
+    {
+        return _M_started;
+    } //! started()
+} //! namespace Fundraising::Analysis
@@ -0,0 +1,67 @@
+#ifndef ROUND_CURSOR_H
+#define ROUND_CURSOR_H 1
+
+#include <cstddef>
+#include <vector>
+#include "basic_types.h"
+#include "matching_base.h"
+
+namespace Fundraising::Analysis
+{
+    //Steps through the matching rounds as donations arrive in timestamp
+    //order, deciding when the pools are refilled from a round and when
+    //they are emptied between rounds. The matcher, its parallel first
+    //pass and the criteria optimizer all go through this, so they agree
+    //on which round each donation falls in.
+    class round_cursor
+    {
+        public:
+            //What a donation does to the matching pools
+            enum change_t
+            {
+                //The pools carry on as they are
+                NO_CHANGE,
+                //The round in progress, if any, ends and round() begins
+                ENTER_ROUND,
+                //The round in progress, if any, ends and no round begins
+                ZERO_POOLS
+            };
+
+            //Creates a cursor before the first donation
+            //@param num_rounds the number of matching rounds
+            explicit round_cursor(size_t num_rounds = 0);
+            //Creates a cursor part way through the rounds, e.g. from a checkpoint
+            //@param num_left the number of rounds not yet over
+            //@param started whether the first donation has been seen
+            round_cursor(size_t num_left, bool started);
+
+            //Decides what the first donation does. The last round the 
+            //donation is in or after is entered, even one that is over, 
+            //which the advance() for the same donation then ends.
+            //@param rounds the matching rounds, latest first
+            //@param dt the timestamp of the first donation
+            //@return ENTER_ROUND or ZERO_POOLS
+            change_t start(const std::vector<matching_criterion_t>& rounds, const date_time_t& dt);
+            //Decides what a donation does to the pools. For the first 
+            //donation, call start() first.
+            //@param rounds the matching rounds, latest first
+            //@param in_round whether a round is in progress
+            //@param dt the timestamp of the donation
+            //@return what to do with the pools
+            change_t advance(const std::vector<matching_criterion_t>& rounds, bool in_round, const date_time_t& dt);
+
+            //Returns the round the last ENTER_ROUND began
+            //@param rounds the matching rounds, latest first
+            const matching_criterion_t& round(const std::vector<matching_criterion_t>& rounds) const;
+            //Returns the number of rounds not yet over
+            size_t num_left() const;
+            //Returns whether start() has been called
+            bool started() const;
+        private:
+            //rounds[_M_num_left - 1] is the round in progress or the next one
+            size_t _M_num_left;
+            bool _M_started;
+    }; //! round_cursor
+} //! namespace Fundraising::Analysis
+
+#endif
@@ -0,0 +1,200 @@
+#include "scenarios.h"
+#include "matching.h"
+#include "Utility/thread_pool.h"
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+
+namespace Fundraising::Analysis
+{
+    //Sets the dancer pool to a percentage of the round's total pool,
+    //the rest going to the general pool
+    static void set_dancer_share(matching_criterion_t& round, donation_val_t percent)
+    {
+        donation_val_t total = round._M_general_amt + round._M_dancer_amt;
+        round._M_dancer_amt = money::from_cents(std::llround(static_cast<double>(total.cents())*percent.cents()/10000.0));
+        round._M_general_amt = total - round._M_dancer_amt;
+    } //! set_dancer_share()
+
+    //The criterion fields a grid can vary
+    struct grid_field_t
+    {
+        const char* _M_name;
+        donation_val_t matching_criterion_t::* _M_field;
+        //Used instead of _M_field for values that aren't a single field
+        void (*_M_set)(matching_criterion_t&, donation_val_t);
+    };
+
+    static const grid_field_t GRID_FIELDS[] = {
+        {"general", &matching_criterion_t::_M_general_amt, nullptr},
+        {"dancer", &matching_criterion_t::_M_dancer_amt, nullptr},
+        {"max-per-donation", &matching_criterion_t::_M_max_per_donation, nullptr},
+        {"max-per-donor", &matching_criterion_t::_M_max_per_donor, nullptr},
+        {"max-per-dancer", &matching_criterion_t::_M_max_per_person, nullptr},
+        {"dancer-share", nullptr, &set_dancer_share}
+    };
+
+    //One grid entry after parsing
+    struct grid_axis_t
+    {
+        const grid_field_t* _M_field;
+        std::vector<std::string> _M_text;
+        std::vector<donation_val_t> _M_values;
+    };
+
+    //Writes an amount the way it would be typed, e.g. 40 or 12.5
+    static std::string amount_text(donation_val_t amt)
+    {
+        std::string text = std::to_string(amt.cents()/100);
+        std::int64_t cents = amt.cents()%100;
+        if (cents != 0)
+        {
+            text += "." + std::to_string(cents/10);
+            if (cents%10 != 0)
+                text += std::to_string(cents%10);
+        }
+        return text;
+    } //! amount_text()
+
+    //Adds one value, or a range of values written lo:hi:step, to an axis
+    static void parse_grid_values(grid_axis_t& axis, std::string_view value)
+    {
+        size_t colon = value.find(':');
+        if (colon == std::string_view::npos)
+        {
+            axis._M_text.emplace_back(value);
+            axis._M_values.push_back(make_donation(value));
+            return;
+        }
+        std::string_view rest = value.substr(colon + 1);
+        size_t second = rest.find(':');
+        if (second == std::string_view::npos)
+            throw std::runtime_error("Invalid grid range \"" + std::string(value) + "\", expected lo:hi:step");
+        donation_val_t lo = make_donation(value.substr(0, colon));
+        donation_val_t hi = make_donation(rest.substr(0, second));
+        donation_val_t step = make_donation(rest.substr(second + 1));
+        if (step <= ZERO || hi < lo)
+            throw std::runtime_error("Invalid grid range \"" + std::string(value) + "\"");
+        for (donation_val_t v = lo; v <= hi; v += step)
+        {
+            axis._M_text.push_back(amount_text(v));
+            axis._M_values.push_back(v);
+        }
+    } //! parse_grid_values()
+
+    static grid_axis_t parse_grid_entry(const std::string& entry)
+    {
+        size_t eq = entry.find('=');
+        if (eq == std::string::npos)
+            throw std::runtime_error("Invalid grid \"" + entry + "\", expected field=value,value,...");
+        std::string name = entry.substr(0, eq);
+        grid_axis_t axis{nullptr, {}, {}};
+        for (const grid_field_t& field: GRID_FIELDS)
+        {
+            if (name == field._M_name)
+                axis._M_field = &field;
+        }
+        if (axis._M_field == nullptr)
+            throw std::runtime_error("Invalid grid field \"" + name + "\"");
+        std::string_view values(entry);
+        values.remove_prefix(eq + 1);
+        while (true)
+        {
+            size_t comma = values.find(',');
+            parse_grid_values(axis, values.substr(0, comma));
+            if (comma == std::string_view::npos)
+                break;
+            values.remove_prefix(comma + 1);
+        }
+        return axis;
+    } //! parse_grid_entry()
+
+    std::vector<scenario_t> make_scenario_grid(const std::vector<matching_criterion_t>& base,
+        const std::vector<std::string>& grid)
+    {
+        std::vector<grid_axis_t> axes;
+        for (const std::string& entry: grid)
+        {
+            axes.push_back(parse_grid_entry(entry));
+            for (size_t a = 0; a + 1 < axes.size(); ++a)
+            {
+                if (axes[a]._M_field == axes.back()._M_field)
+                    throw std::runtime_error("Grid field \"" + std::string(axes.back()._M_field->_M_name) + "\" given twice");
+            }
+        }
+
+        //Count through the combinations like an odometer, the last
+        //entry changing fastest
+        std::vector<scenario_t> scenarios;
+        std::vector<size_t> choice(axes.size(), 0);
+        while (true)
+        {
+            scenario_t scenario{"", base};
+            for (size_t a = 0; a < axes.size(); ++a)
+            {
+                const grid_axis_t& axis = axes[a];
+                for (matching_criterion_t& round: scenario._M_rounds)
+                {
+                    if (axis._M_field->_M_set != nullptr)
+                        axis._M_field->_M_set(round, axis._M_values[choice[a]]);
+                    else
+                        round.*(axis._M_field->_M_field) = axis._M_values[choice[a]];
+                }
+                if (!scenario._M_name.empty())
+                    scenario._M_name += " ";
+                scenario._M_name += std::string(axis._M_field->_M_name) + "=" + axis._M_text[choice[a]];
+            }
+            if (scenario._M_name.empty())
+                scenario._M_name = "base";
+            scenarios.push_back(std::move(scenario));
+
+            size_t a = axes.size();
+            while (a > 0 && ++choice[a - 1] == axes[a - 1]._M_values.size())
+                choice[--a] = 0;
+            if (a == 0)
+                break;
+        }
+        return scenarios;
+    } //! make_scenario_grid()
+
+    donation_val_t total_unused(const std::vector<std::pair<date_time_t, donation_val_t>>& unused)
+    {
+        return unused.empty() ? ZERO : unused.back().second;
+    } //! total_unused()
+
+    //Sums up a finished matcher
+    static scenario_result_t summarize(const std::string& name, const matcher& m)
+    {
+        scenario_result_t result;
+        result._M_name = name;
+        for (const auto& [id, dancer]: m.get_matching_information())
+        {
+            role_summary_t& role = result._M_roles[dancer._M_dancer_role];
+            role._M_raised = role._M_raised + dancer._M_amt_raised;
+            role._M_matched = role._M_matched + dancer._M_amt_matched;
+            ++role._M_num_dancers;
+            if (dancer._M_amt_matched > ZERO)
+                ++role._M_num_matched;
+            result._M_total_raised = result._M_total_raised + dancer._M_amt_raised;
+            result._M_total_matched = result._M_total_matched + dancer._M_amt_matched;
+        }
+        result._M_unused_general = m.get_general_matching_money_left();
+        result._M_unused_dancer = m.get_dancer_matching_money_left();
+        return result;
+    } //! summarize()
+
+    std::vector<scenario_result_t> run_scenarios(std::shared_ptr<const std::vector<donation_t>> donations,
+        const std::vector<scenario_t>& scenarios)
+    {
+        std::vector<scenario_result_t> results(scenarios.size());
+        //Each matcher is dropped as soon as it is summed up, so only as
+        //many are alive as there are threads
+        Utility::parallel_for(scenarios.size(), [&](size_t s)
+        {
+            matcher m(donations, scenarios[s]._M_rounds);
+            m.perform_matching_calculations();
+            results[s] = summarize(scenarios[s]._M_name, m);
+        });
+        return results;
+    } //! run_scenarios()
+} //! namespace Fundraising::Analysis
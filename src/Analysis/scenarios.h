@@ -0,0 +1,78 @@
+#ifndef SCENARIOS_H
+#define SCENARIOS_H 1
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "basic_types.h"
+#include "matching_base.h"
+
+namespace Fundraising::Analysis
+{
+    //One set of matching criteria to try, e.g. "what if the general
+    //pool were $6000 and max per donor $40?"
+    struct scenario_t
+    {
+        //Name shown in the comparison table
+        std::string _M_name;
+        //The matching rounds, latest first like the matcher expects
+        std::vector<matching_criterion_t> _M_rounds;
+    };
+
+    //The totals for one role under a scenario
+    struct role_summary_t
+    {
+        donation_val_t _M_raised;
+        donation_val_t _M_matched;
+        size_t _M_num_dancers = 0;
+        //Number of dancers matched anything
+        size_t _M_num_matched = 0;
+    };
+
+    //What matching the donations under a scenario came to
+    struct scenario_result_t
+    {
+        std::string _M_name;
+        donation_val_t _M_total_raised;
+        donation_val_t _M_total_matched;
+        //Money left in the pools at the end of each round
+        std::vector<std::pair<date_time_t, donation_val_t>> _M_unused_general;
+        std::vector<std::pair<date_time_t, donation_val_t>> _M_unused_dancer;
+        std::map<symbol_t, role_summary_t> _M_roles;
+    };
+
+    //Returns the matching money never used over all rounds. What is 
+    //left of each round is carried into the next, so this is what was 
+    //left of the last round rather than the sum over rounds.
+    //@param unused money left at the end of each round, in order
+    //@return the money left unused, zero if there were no rounds
+    donation_val_t total_unused(const std::vector<std::pair<date_time_t, donation_val_t>>& unused);
+
+    //Builds one scenario for each combination of values in a grid, each
+    //a copy of the base criteria with the given fields set in every round.
+    //A grid entry is written field=value,value,... where field is one of
+    //general, dancer, max-per-donation, max-per-donor, max-per-dancer or
+    //dancer-share. Values are dollar amounts without thousands separators,
+    //or lo:hi:step for every step from lo to hi. dancer-share splits each
+    //round's total pool, giving that percentage to the dancer pool.
+    //@param base the criteria to start from
+    //@param grid the grid entries
+    //@return the scenarios, named after the values they set, e.g.
+    //"general=6000 max-per-donor=40"
+    std::vector<scenario_t> make_scenario_grid(const std::vector<matching_criterion_t>& base,
+        const std::vector<std::string>& grid);
+
+    //Matches the same donations under each scenario. The donations are
+    //shared by all the matchers rather than copied, and the scenarios
+    //are run at the same time on the shared thread pool.
+    //@param donations the donations, matched in the order given
+    //@param scenarios the scenarios to run
+    //@return the results, in the same order as the scenarios
+    std::vector<scenario_result_t> run_scenarios(std::shared_ptr<const std::vector<donation_t>> donations,
+        const std::vector<scenario_t>& scenarios);
+} //! namespace Fundraising::Analysis
+
+#endif
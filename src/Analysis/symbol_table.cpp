@@ -0,0 +1,130 @@
+#include "symbol_table.h"
+#include <mutex>
+
+namespace Fundraising
+{
+    std::ostream& operator<<(std::ostream& os, const Analysis::symbol_t& symbol)
+    {
+        return os << symbol.str();
+    } //! operator<<()
+} //! namespace Fundraising
+
+namespace Fundraising::Analysis
+{
+    symbol_t::symbol_t()
+        : symbol_t(std::string_view())
+    {
+
+    } //! symbol_t()
+
+    symbol_t::symbol_t(std::string_view value)
+        : _M_entry(symbol_table::instance().intern(value))
+    {
+
+    } //! symbol_t()
+
+    symbol_t::symbol_t(const std::string& value)
+        : symbol_t(std::string_view(value))
+    {
+
+    } //! symbol_t()
+
+    symbol_t::symbol_t(const char* value)
+        : symbol_t(std::string_view(value))
+    {
+
+    } //! symbol_t()
+
+    const std::string& symbol_t::str() const
+    {
+        return _M_entry->_M_value;
+    } //! str()
+
+    symbol_t::operator const std::string&() const
+    {
+        return _M_entry->_M_value;
+    } //! operator const std::string&()
+
+    bool symbol_t::has_flag(symbol_flag flag) const
+    {
+        return (_M_entry->_M_flags & flag) != 0;
+    } //! has_flag()
+
+    bool symbol_t::empty() const
+    {
+        return _M_entry->_M_value.empty();
+    } //! empty()
+
+    bool operator==(const symbol_t& lhs, const symbol_t& rhs)
+    {
+        return lhs._M_entry == rhs._M_entry;
+    } //! operator==()
+
+    bool operator!=(const symbol_t& lhs, const symbol_t& rhs)
+    {
+        return lhs._M_entry != rhs._M_entry;
+    } //! operator!=()
+
+    bool operator<(const symbol_t& lhs, const symbol_t& rhs)
+    {
+        return lhs != rhs && lhs.str() < rhs.str();
+    } //! operator<()
+
+    symbol_table& symbol_table::instance()
+    {
+        static symbol_table table;
+        return table;
+    } //! instance()
+
+    const symbol_t::entry_t* symbol_table::intern(std::string_view value)
+    {
+        //Entries are never removed, so each thread can remember the ones 
+        //it has already looked up without taking the lock again
+        thread_local std::unordered_map<std::string_view, const symbol_t::entry_t*> cache;
+        auto cached = cache.find(value);
+        if (cached != cache.end())
+            return cached->second;
+
+        const symbol_t::entry_t* entry = nullptr;
+        {
+            std::shared_lock<std::shared_mutex> lock(_M_mutex);
+            auto it = _M_index.find(value);
+            if (it != _M_index.end())
+                entry = it->second;
+        }
+        if (entry == nullptr)
+        {
+            std::unique_lock<std::shared_mutex> lock(_M_mutex);
+            //Another thread may have added it in the meantime
+            auto it = _M_index.find(value);
+            if (it != _M_index.end())
+                entry = it->second;
+            else
+            {
+                _M_entries.push_back({std::string(value), classify(value)});
+                entry = &_M_entries.back();
+                _M_index.emplace(entry->_M_value, entry);
+            }
+        }
+        cache.emplace(entry->_M_value, entry);
+        return entry;
+    } //! intern()
+
+    size_t symbol_table::size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(_M_mutex);
+        return _M_entries.size();
+    } //! size()
+
+    unsigned symbol_table::classify(std::string_view value)
+    {
+        unsigned flags = 0;
+        if (value == "Dancer")
+            flags |= DANCER_ROLE;
+        if (value == "DMUM")
+            flags |= DMUM_ROLE;
+        if (value.find("DMUM Alumni") != std::string_view::npos)
+            flags |= ALUMNI_RELATION;
+        return flags;
+    } //! classify()
+} //! namespace Fundraising::Analysis
@@ -0,0 +1,119 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H 1
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Fundraising::Analysis
+{
+    //Properties of a value that are worked out once, when the value is 
+    //first interned, so hot paths can test a bit instead of comparing text
+    enum symbol_flag : unsigned
+    {
+        //The value is exactly "Dancer"
+        DANCER_ROLE = 1u << 0,
+        //The value is exactly "DMUM"
+        DMUM_ROLE = 1u << 1,
+        //The value mentions "DMUM Alumni"
+        ALUMNI_RELATION = 1u << 2
+    };
+
+    //A string stored once in the symbol table. Used for columns with only 
+    //a few distinct values, such as roles, houses, teams and relations. 
+    //A symbol is the size of a pointer, copying it never allocates and 
+    //two symbols are equal exactly when they refer to the same entry.
+    class symbol_t
+    {
+        public:
+            //One interned value
+            struct entry_t
+            {
+                std::string _M_value;
+                unsigned _M_flags;
+            };
+
+            //Creates the symbol for the empty string
+            symbol_t();
+            //Creates the symbol for a value, interning it if it is new
+            //@param value the text of the symbol
+            symbol_t(std::string_view value);
+            symbol_t(const std::string& value);
+            symbol_t(const char* value);
+
+            //Returns the text of the symbol
+            //@return the interned string. Valid for the life of the program
+            const std::string& str() const;
+            operator const std::string&() const;
+            //Returns whether the value has a property
+            //@param flag the property to test
+            //@return true if the flag was set when the value was interned
+            bool has_flag(symbol_flag flag) const;
+            //Returns whether the symbol is the empty string
+            bool empty() const;
+
+            friend bool operator==(const symbol_t& lhs, const symbol_t& rhs);
+            friend bool operator!=(const symbol_t& lhs, const symbol_t& rhs);
+        private:
+            const entry_t* _M_entry;
+    }; //! symbol_t
+
+    //Orders symbols by their text, so output sorted by symbol is stable 
+    //from run to run
+    bool operator<(const symbol_t& lhs, const symbol_t& rhs);
+
+    //Process wide store of interned strings. Entries are never removed, 
+    //so symbols stay valid for the life of the program. Safe to use from 
+    //several threads at once.
+    class symbol_table
+    {
+        public:
+            //Returns the table shared by the whole program
+            static symbol_table& instance();
+
+            //Returns the entry for a value, adding it if it is new
+            //@param value the text to intern
+            //@return the entry for the value
+            const symbol_t::entry_t* intern(std::string_view value);
+            //Returns the number of distinct values interned
+            size_t size() const;
+        private:
+            symbol_table() = default;
+            symbol_table(const symbol_table&) = delete;
+            symbol_table& operator=(const symbol_table&) = delete;
+
+            //Works out the flags of a new value
+            static unsigned classify(std::string_view value);
+        private:
+            mutable std::shared_mutex _M_mutex;
+            //A deque never moves its elements, so entries can be pointed to
+            std::deque<symbol_t::entry_t> _M_entries;
+            //Keys point into _M_entries
+            std::unordered_map<std::string_view, const symbol_t::entry_t*> _M_index;
+    }; //! symbol_table
+} //! namespace Fundraising::Analysis
+
+namespace Fundraising
+{
+    std::ostream& operator<<(std::ostream& os, const Analysis::symbol_t& symbol);
+} //! namespace Fundraising
+
+namespace std
+{
+    template<>
+    struct hash<Fundraising::Analysis::symbol_t>
+    {
+        size_t operator()(const Fundraising::Analysis::symbol_t& s) const
+        {
+            //Each value is stored once, so its address identifies it
+            return std::hash<const void*>{}(&s.str());
+        }
+    };
+} //! namespace std
+
+#endif
@@ -1,18 +1,38 @@
 #include "command_line_interface.h"
 #include "Analysis/criterion_parser.h"
 #include "Analysis/matching.h"
+#include "Analysis/scenarios.h"
+#include "Analysis/criteria_optimizer.h"
 #include "File_IO/csv_io.h"
+#include "File_IO/excel_io.h"
+#include "File_IO/snapshot_io.h"
+#include "File_IO/csv_follower.h"
+#include "File_IO/checkpoint_io.h"
+#include "File_IO/compressed_input.h"
 #include <getopt.h>
 #include <stdexcept>
 #include <iostream>
+#include <fstream>
+#include <string_view>
 #include <algorithm>
+#include <chrono>
+#include <thread>
+#include <memory>
 
 option long_options[] = 
 {
     {"input", required_argument, nullptr, 'i'},
     {"output", required_argument, nullptr, 'o'},
     {"num_donations", required_argument, nullptr, 'n'}, 
+    {"num-donations", required_argument, nullptr, 'n'}, 
     {"criteria", required_argument, nullptr, 'c'},
+    {"stream", no_argument, nullptr, 's'},
+    {"no-snapshot", no_argument, nullptr, 'S'},
+    {"follow", required_argument, nullptr, 'f'},
+    {"checkpoint", required_argument, nullptr, 'k'},
+    {"what-if", required_argument, nullptr, 'w'},
+    {"grid", required_argument, nullptr, 'g'},
+    {"optimize", required_argument, nullptr, 'O'},
     {"help", no_argument, nullptr, 'h'},
     {nullptr, 0, nullptr, 0}
 };
@@ -26,10 +46,15 @@ namespace Fundraising::Command_Line
         bool output_seen = false;
         bool num_donations_seen = false;
         bool criteia_file_seen = false;
+        bool stream_seen = false;
+        bool no_snapshot_seen = false;
+        bool follow_seen = false;
+        bool optimize_seen = false;
+        bool checkpoint_seen = false;
 
         int choice = 0;
         long long num_d;
-        while ((choice = getopt_long(argc, argv, "i:o:n:c:h", long_options, nullptr)) != -1) 
+        while ((choice = getopt_long(argc, argv, "i:o:n:c:sf:k:w:g:O:h", long_options, nullptr)) != -1) 
         {
             switch(choice)
             {
@@ -60,6 +85,52 @@ namespace Fundraising::Command_Line
                     criteia_file_seen = true;
                     ops._M_criterion_input_file = optarg;
                     break;
+                case 's':
+                    if (stream_seen)
+                        throw std::invalid_argument("May only specify streaming once");
+                    stream_seen = true;
+                    ops._M_stream = true;
+                    break;
+                case 'S':
+                    if (no_snapshot_seen)
+                        throw std::invalid_argument("May only specify no snapshot once");
+                    no_snapshot_seen = true;
+                    ops._M_use_snapshot = false;
+                    break;
+                case 'f':
+                    if (follow_seen)
+                        throw std::invalid_argument("May only specify follow once");
+                    follow_seen = true;
+                    num_d = std::atoll(optarg);
+                    if (num_d <= 0)
+                        throw std::invalid_argument("Follow interval must be a positive number of seconds");
+                    ops._M_follow_interval = static_cast<unsigned>(num_d);
+                    break;
+                case 'k':
+                    if (checkpoint_seen)
+                        throw std::invalid_argument("May only specify checkpoint once");
+                    checkpoint_seen = true;
+                    ops._M_checkpoint_file = optarg;
+                    break;
+                case 'w':
+                    ops._M_scenario_files.push_back(optarg);
+                    break;
+                case 'g':
+                    ops._M_grid.push_back(optarg);
+                    break;
+                case 'O':
+                    if (optimize_seen)
+                        throw std::invalid_argument("May only specify optimize once");
+                    optimize_seen = true;
+                    ops._M_optimize = true;
+                    try
+                    {
+                        ops._M_target_unused = Analysis::make_donation(std::string_view(optarg));
+                    } catch (const std::runtime_error& ex)
+                    {
+                        throw std::invalid_argument(ex.what());
+                    }
+                    break;
                 case 'h': 
                     std::cout << 
                     " --input [filename] or -i [filename] \n"
@@ -67,9 +138,37 @@ namespace Fundraising::Command_Line
                     "--output [folder name] or -o [folder name] \n"
                     "   (Optional) Specify the output directory name\n"
                     "--num-donations [amount] or -n [amount]\n"
-                    "   (Optional) Specify the number of donations. Optional but doing so may speed up the proprgram.\n"
+                    "   (Optional) Specify the number of donations. Only that many donations are read, and memory\n"
+                    "   is set aside for them up front. If not given, the number is estimated from the file size.\n"
                     "--criteria [filenname] or -c [filename]\n"
-                    "   (Optional) Specify a filename with matching criteria"
+                    "   (Optional) Specify a filename with matching criteria\n"
+                    "--stream or -s\n"
+                    "   (Optional) Match donations as they are read instead of loading the whole file first.\n"
+                    "   Uses memory proportional to the number of donors and dancers rather than donations.\n"
+                    "--no-snapshot\n"
+                    "   (Optional) Always parse the input file. Otherwise the parsed donations are saved to\n"
+                    "   [filename].snapshot and reused while the input file is unchanged.\n"
+                    "--follow [seconds] or -f [seconds]\n"
+                    "   (Optional) Keep running and check a .csv input file for new rows every [seconds].\n"
+                    "   Only new rows are read and matched, then the output files are rewritten. Stop with Ctrl-C.\n"
+                    "--checkpoint [filename] or -k [filename]\n"
+                    "   (Optional) With --follow, save the matcher to [filename] after every check that finds new\n"
+                    "   rows. A later run following the same file with the same criteria carries on from the\n"
+                    "   checkpoint instead of matching the file again. If either changed, it is ignored.\n"
+                    "--what-if [filename] or -w [filename]\n"
+                    "   (Optional) Compare matching under another criteria file. May be given more than once.\n"
+                    "   The donations are read once and every set of criteria is matched at the same time. Writes\n"
+                    "   scenarios.csv, scenario_rounds.csv and scenario_roles.csv instead of the usual outputs.\n"
+                    "--grid [field=value,value,...] or -g [field=value,value,...]\n"
+                    "   (Optional) Compare matching under every combination of values for the --criteria file,\n"
+                    "   e.g. -g general=4000,6000 -g max-per-donor=40,50. Fields are general, dancer,\n"
+                    "   max-per-donation, max-per-donor, max-per-dancer and dancer-share, the percentage of each\n"
+                    "   round's pool set aside for dancers. A value may be a range lo:hi:step, e.g. 10:100:5.\n"
+                    "   May be given more than once.\n"
+                    "--optimize [amount] or -O [amount]\n"
+                    "   (Optional) Search the --grid for the criteria leaving closest to [amount] unused in the\n"
+                    "   pools, 0 to use as much of them as possible. Writes optimizer.csv ranking every\n"
+                    "   combination and optimized_criteria.txt holding the best one."
                     ;
                     std::exit(EXIT_SUCCESS);
                     break;
@@ -81,9 +180,37 @@ namespace Fundraising::Command_Line
                     "--output [folder name] or -o [folder name] \n"
                     "   (Optional) Specify the output directory name\n"
                     "--num-donations [amount] or -n [amount]\n"
-                    "   (Optional) Specify the number of donations. Optional but doing so may speed up the program."
+                    "   (Optional) Specify the number of donations. Only that many donations are read, and memory\n"
+                    "   is set aside for them up front. If not given, the number is estimated from the file size.\n"
                     "--criteria [filenname] or -c [filename]\n"
-                    "   (Optional) Specify a filename with matching criteria"
+                    "   (Optional) Specify a filename with matching criteria\n"
+                    "--stream or -s\n"
+                    "   (Optional) Match donations as they are read instead of loading the whole file first.\n"
+                    "   Uses memory proportional to the number of donors and dancers rather than donations.\n"
+                    "--no-snapshot\n"
+                    "   (Optional) Always parse the input file. Otherwise the parsed donations are saved to\n"
+                    "   [filename].snapshot and reused while the input file is unchanged.\n"
+                    "--follow [seconds] or -f [seconds]\n"
+                    "   (Optional) Keep running and check a .csv input file for new rows every [seconds].\n"
+                    "   Only new rows are read and matched, then the output files are rewritten. Stop with Ctrl-C.\n"
+                    "--checkpoint [filename] or -k [filename]\n"
+                    "   (Optional) With --follow, save the matcher to [filename] after every check that finds new\n"
+                    "   rows. A later run following the same file with the same criteria carries on from the\n"
+                    "   checkpoint instead of matching the file again. If either changed, it is ignored.\n"
+                    "--what-if [filename] or -w [filename]\n"
+                    "   (Optional) Compare matching under another criteria file. May be given more than once.\n"
+                    "   The donations are read once and every set of criteria is matched at the same time. Writes\n"
+                    "   scenarios.csv, scenario_rounds.csv and scenario_roles.csv instead of the usual outputs.\n"
+                    "--grid [field=value,value,...] or -g [field=value,value,...]\n"
+                    "   (Optional) Compare matching under every combination of values for the --criteria file,\n"
+                    "   e.g. -g general=4000,6000 -g max-per-donor=40,50. Fields are general, dancer,\n"
+                    "   max-per-donation, max-per-donor, max-per-dancer and dancer-share, the percentage of each\n"
+                    "   round's pool set aside for dancers. A value may be a range lo:hi:step, e.g. 10:100:5.\n"
+                    "   May be given more than once.\n"
+                    "--optimize [amount] or -O [amount]\n"
+                    "   (Optional) Search the --grid for the criteria leaving closest to [amount] unused in the\n"
+                    "   pools, 0 to use as much of them as possible. Writes optimizer.csv ranking every\n"
+                    "   combination and optimized_criteria.txt holding the best one."
                     ;
                     std::exit(EXIT_SUCCESS);
                     break;
@@ -97,9 +224,238 @@ namespace Fundraising::Command_Line
             ops._M_num_donations = 0;
         if(!criteia_file_seen)
             ops._M_criterion_input_file = "";
+        if(!stream_seen)
+            ops._M_stream = false;
+        if(!no_snapshot_seen)
+            ops._M_use_snapshot = true;
+        if(!follow_seen)
+            ops._M_follow_interval = 0;
+        if(follow_seen && num_donations_seen)
+            throw std::invalid_argument("May not limit the number of donations while following a file");
+        if(checkpoint_seen && !follow_seen)
+            throw std::invalid_argument("May only checkpoint while following a file");
+        if(!ops._M_scenario_files.empty() || !ops._M_grid.empty())
+        {
+            if (stream_seen || follow_seen)
+                throw std::invalid_argument("May not compare scenarios while streaming or following a file");
+            if (!ops._M_grid.empty() && !criteia_file_seen)
+                throw std::invalid_argument("Must specify a criteria file to vary with --grid");
+        }
+        if(optimize_seen && (ops._M_grid.empty() || !ops._M_scenario_files.empty()))
+            throw std::invalid_argument("Must specify a --grid, and no --what-if files, to optimize");
         return ops;
     }
 
+    //Writes the results of matching to the output folder
+    //@param m the matcher to report on 
+    //@param output_folder the directory to write the .csv files to
+    static void write_outputs(const Analysis::matcher& m, const std::string& output_folder)
+    {
+        //Get matching information
+        auto matching_info = m.get_matching_information();
+        auto dancer_matching_left = m.get_dancer_matching_money_left();
+        auto general_matching_left = m.get_general_matching_money_left();
+        auto donor_info = m.get_donor_information();
+        auto alumni_info = m.get_alumni_donor_information();
+        auto dancer_statistics = m.get_dancer_statistics();
+        auto hour_statistics = m.get_hourly_statistics();
+        //Output matching information
+        for(auto it1 = dancer_matching_left.begin(), it2 = general_matching_left.begin(); it1 != dancer_matching_left.end(); ++it1, ++it2)
+        {
+            std::cout << "Dancer matching money unused during round beginning at " << static_cast<std::string>(it1->first) << ": " << it1->second << "\n";
+            std::cout << "General matching money unused during round beginning at " << static_cast<std::string>(it2->first) << ": " << it2->second << "\n";
+            std::cout << "\n";
+        }
+        IO::write_to_csv(output_folder + "/matching.csv", matching_info.begin(), matching_info.end(), IO::matching_header, IO::matching_row_func);
+        IO::write_to_csv(output_folder + "/dancer_statics.csv", dancer_statistics.begin(), dancer_statistics.end(), IO::statistics_header, IO::statistics_row_func);
+        IO::write_to_csv(output_folder + "/donors.csv", donor_info.begin(), donor_info.end(), IO::donor_header, IO::donor_row_func);
+        IO::write_to_csv(output_folder + "/alumni_donors.csv", alumni_info.begin(), alumni_info.end(), IO::alumni_donor_header, IO::alumni_row_func);
+        IO::write_to_csv(output_folder + "/alumni_statistics.csv", alumni_info.begin(), alumni_info.end(), IO::alumni_statistics_header, IO::alumni_statistics_row);
+        IO::write_to_csv(output_folder + "/hourly_statistics.csv", hour_statistics.begin(), hour_statistics.end(), IO::hourly_statistics_header, IO::hour_statistics_func);
+    }
+
+    //Reads a matching criteria file, exiting if it can't be read
+    //@param filename the criteria file
+    //@return the matching rounds, latest first
+    static std::vector<Analysis::matching_criterion_t> read_criteria_file(const std::string& filename)
+    {
+        std::vector<Analysis::matching_criterion_t> criteria;
+        std::ifstream criteria_in(filename.c_str());
+        if(!criteria_in.is_open())
+        {
+            std::cerr << "Error opening file" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        Analysis::parser p(criteria_in);
+        try {
+        criteria = p.parse_criteria();
+        } catch (const std::runtime_error& ex) {
+            std::cerr << ex.what() << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::sort(criteria.begin(), criteria.end(), [](const Analysis::matching_criterion_t& lhs, const Analysis::matching_criterion_t& rhs){return lhs._M_start > rhs._M_start;});
+        return criteria;
+    }
+
+    //Reads all the donations in the input file, from its snapshot if 
+    //there is an up to date one
+    //@param ops the command line options
+    //@return the donations in file order
+    static std::vector<Analysis::donation_t> read_donations(const opts& ops)
+    {
+        const std::string& filename = ops._M_input_file;
+        std::vector<Analysis::donation_t> donations;
+        if (!ops._M_use_snapshot || !IO::read_snapshot_donations(filename, donations, ops._M_num_donations))
+        {
+            donations = IO::is_excel_file(filename) ? 
+                IO::read_excel_donations(filename, ops._M_num_donations) : IO::read_csv_donations(filename, ops._M_num_donations);
+            //A partial read can't stand in for the whole file
+            if (ops._M_use_snapshot && ops._M_num_donations == 0)
+                IO::write_snapshot_donations(filename, donations);
+        }
+        return donations;
+    }
+
+    //Matches the donations under each --what-if file and --grid 
+    //combination and writes a table comparing them. The --criteria 
+    //file, if given, is the first scenario.
+    //@param donations the donations, in file order
+    //@param criteria the --criteria rounds, latest first
+    //@param ops the command line options
+    static void compare_scenarios(std::vector<Analysis::donation_t>&& donations, 
+        const std::vector<Analysis::matching_criterion_t>& criteria, const opts& ops)
+    {
+        std::vector<Analysis::scenario_t> scenarios;
+        if (!ops._M_criterion_input_file.empty())
+            scenarios.push_back({ops._M_criterion_input_file, criteria});
+        for (const std::string& file: ops._M_scenario_files)
+            scenarios.push_back({file, read_criteria_file(file)});
+        if (!ops._M_grid.empty())
+        {
+            try
+            {
+                for (auto& scenario: Analysis::make_scenario_grid(criteria, ops._M_grid))
+                    scenarios.push_back(std::move(scenario));
+            } catch (const std::runtime_error& ex)
+            {
+                std::cerr << ex.what() << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        auto shared = std::make_shared<const std::vector<Analysis::donation_t>>(std::move(donations));
+        std::vector<Analysis::scenario_result_t> results = Analysis::run_scenarios(shared, scenarios);
+
+        std::vector<IO::scenario_round_row> rounds;
+        std::vector<IO::scenario_role_row> roles;
+        for (const auto& r: results)
+        {
+            std::cout << r._M_name << ": " << r._M_total_matched << " matched\n";
+            for (size_t i = 0; i < r._M_unused_general.size(); ++i)
+                rounds.emplace_back(r._M_name, r._M_unused_general[i].first, r._M_unused_general[i].second, r._M_unused_dancer[i].second);
+            for (const auto& [role, summary]: r._M_roles)
+                roles.emplace_back(r._M_name, role, summary);
+        }
+        IO::write_to_csv(ops._M_output_folder + "/scenarios.csv", results.begin(), results.end(), IO::scenario_header, IO::scenario_row_func);
+        IO::write_to_csv(ops._M_output_folder + "/scenario_rounds.csv", rounds.begin(), rounds.end(), IO::scenario_round_header, IO::scenario_round_func);
+        IO::write_to_csv(ops._M_output_folder + "/scenario_roles.csv", roles.begin(), roles.end(), IO::scenario_role_header, IO::scenario_role_func);
+    }
+
+    //Searches the --grid for the criteria leaving closest to the 
+    //--optimize amount unused, writing every combination ranked best 
+    //first and the best criteria
+    //@param donations the donations, in file order
+    //@param criteria the --criteria rounds, latest first
+    //@param ops the command line options
+    static void optimize_criteria(const std::vector<Analysis::donation_t>& donations, 
+        const std::vector<Analysis::matching_criterion_t>& criteria, const opts& ops)
+    {
+        std::vector<Analysis::scenario_t> candidates;
+        try
+        {
+            candidates = Analysis::make_scenario_grid(criteria, ops._M_grid);
+        } catch (const std::runtime_error& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        Analysis::match_evaluator evaluator(donations);
+        std::vector<Analysis::candidate_result_t> results = Analysis::optimize_criteria(evaluator, candidates, ops._M_target_unused);
+
+        const Analysis::candidate_result_t& best = results.front();
+        std::cout << "Best of " << candidates.size() << " candidates: " << candidates[best._M_candidate]._M_name << "\n";
+        std::cout << "Matched " << best._M_total_matched << ", unused general " << best._M_unused_general;
+        std::cout << ", unused dancer " << best._M_unused_dancer << "\n";
+        IO::write_to_csv(ops._M_output_folder + "/optimizer.csv", results.begin(), results.end(), IO::optimizer_header, 
+            [&candidates](std::ostream& fout, const Analysis::candidate_result_t& r)->std::ostream&
+            {
+                return IO::optimizer_row_func(fout, candidates[r._M_candidate]._M_name, r);
+            });
+        std::ofstream criteria_out(ops._M_output_folder + "/optimized_criteria.txt");
+        Analysis::writer w(criteria_out);
+        w.write_criteria(candidates[best._M_candidate]._M_rounds);
+    }
+
+    //Matches the donations in a .csv file as rows are appended to it,
+    //rewriting the outputs after every check that finds new rows.
+    //Never returns.
+    //@param filename the export to follow
+    //@param criteria the matching criteria, latest first
+    //@param ops the command line options
+    [[noreturn]] static void follow_csv_file(const std::string& filename, const std::vector<Analysis::matching_criterion_t>& criteria, 
+        const opts& ops)
+    {
+        if (IO::is_excel_file(filename))
+        {
+            std::cout << "Error: only .csv files can be followed. Program terminated." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        //Rows can't be appended to a compressed file as it is read
+        char head[4] = {};
+        std::ifstream head_in(filename, std::ios::binary);
+        head_in.read(head, sizeof(head));
+        if (IO::detect_compression(std::string_view(head, head_in.gcount())) != IO::compression_t::NONE)
+        {
+            std::cout << "Error: " << filename << " is compressed, only uncompressed .csv files can be followed. Program terminated." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        //The matcher carries over from one check to the next, so each
+        //check only costs as much as the rows it finds
+        Analysis::matcher m(criteria);
+        IO::csv_follower follower(filename);
+        size_t total = 0;
+        IO::follow_position_t position;
+        if (!ops._M_checkpoint_file.empty() && IO::read_checkpoint(ops._M_checkpoint_file, filename, criteria, m, position))
+        {
+            follower.resume(position._M_offset, position._M_line_no);
+            total = position._M_num_donations;
+            m.finish_matching();
+            write_outputs(m, ops._M_output_folder);
+            std::cout << "Resumed from " << ops._M_checkpoint_file << " after " << total << " donation(s)" << std::endl;
+        }
+        while (true)
+        {
+            size_t num_read = 0;
+            try
+            {
+                num_read = follower.read_new_rows([&m](const Analysis::donation_t& donation) {m.add_donation(donation);});
+            } catch (const std::runtime_error& ex)
+            {
+                std::cout << "Error: " << ex.what() << ". Program terminated." << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (num_read > 0)
+            {
+                total += num_read;
+                m.finish_matching();
+                write_outputs(m, ops._M_output_folder);
+                if (!ops._M_checkpoint_file.empty())
+                    IO::write_checkpoint(ops._M_checkpoint_file, filename, criteria, m, {follower.offset(), follower.line_no(), total});
+                std::cout << "Read " << num_read << " new donation(s), " << total << " in total" << std::endl;
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(ops._M_follow_interval));
+        }
+    }
+
     void command_line_run(int argc, char** argv)
     {
         opts ops;
@@ -116,7 +472,6 @@ namespace Fundraising::Command_Line
             exit(EXIT_FAILURE);
         }
         std::string filename = ops._M_input_file;
-        std::vector<Analysis::donation_t> donations = IO::read_csv_donations(filename);
 
         //Eventually, these will be read from a file?
         /*
@@ -141,51 +496,49 @@ namespace Fundraising::Command_Line
         
         std::vector<Analysis::matching_criterion_t> criteria;
         if (!ops._M_criterion_input_file.empty()) 
+            criteria = read_criteria_file(ops._M_criterion_input_file);
+        for(const auto& c: criteria)
         {
-            std::ifstream criteria_in(ops._M_criterion_input_file.c_str());
-            if(!criteria_in.is_open())
+            std::cout << static_cast<std::string>(c._M_start) << std::endl;
+        }
+        if (ops._M_follow_interval > 0)
+            follow_csv_file(filename, criteria, ops);
+        if (ops._M_stream)
+        {
+            //Match each donation as it is read, never holding the whole file
+            Analysis::matcher m(criteria);
+            size_t num_donations = ops._M_num_donations;
+            auto consume = [&m](const Analysis::donation_t& donation) {m.add_donation(donation);};
+            bool from_snapshot = ops._M_use_snapshot && IO::stream_snapshot_donations(filename, consume, num_donations);
+            if (!from_snapshot && IO::is_excel_file(filename))
             {
-                std::cerr << "Error opening file" << std::endl;
-                exit(EXIT_FAILURE);
+                m.reserve(num_donations);
+                IO::stream_excel_donations(filename, consume, num_donations);
             }
-            Analysis::parser p(criteria_in);
-            try {
-            criteria = p.parse_criteria();
-            } catch (const std::runtime_error& ex) {
-                std::cerr << ex.what() << std::endl;
-                exit(EXIT_FAILURE);
+            else if (!from_snapshot)
+            {
+                m.reserve((num_donations == 0) ? IO::estimate_csv_donations(filename) : num_donations);
+                IO::stream_csv_donations(filename, consume, num_donations);
             }
+            m.finish_matching();
+            write_outputs(m, ops._M_output_folder);
+            return;
         }
-        std::sort(criteria.begin(), criteria.end(), [](const Analysis::matching_criterion_t& lhs, const Analysis::matching_criterion_t& rhs){return lhs._M_start > rhs._M_start;});
-        for(const auto& c: criteria)
+        std::vector<Analysis::donation_t> donations = read_donations(ops);
+        if (ops._M_optimize)
         {
-            std::cout << static_cast<std::string>(c._M_start) << std::endl;
+            optimize_criteria(donations, criteria, ops);
+            return;
+        }
+        if (!ops._M_scenario_files.empty() || !ops._M_grid.empty())
+        {
+            compare_scenarios(std::move(donations), criteria, ops);
+            return;
         }
         //Create matching class
-        Analysis::matcher m(donations, criteria);
+        Analysis::matcher m(std::move(donations), std::move(criteria));
         //Perform matching calculations
         m.perform_matching_calculations();
-        //Get matching information
-        auto matching_info = m.get_matching_information();
-        auto dancer_matching_left = m.get_dancer_matching_money_left();
-        auto general_matching_left = m.get_general_matching_money_left();
-        auto donor_info = m.get_donor_information();
-        auto alumni_info = m.get_alumni_donor_information();
-        auto dancer_statistics = m.get_dancer_statistics();
-        auto hour_statistics = m.get_hourly_statistics();
-        //Output matching information
-        std::string output_folder = ops._M_output_folder;
-        for(auto it1 = dancer_matching_left.begin(), it2 = general_matching_left.begin(); it1 != dancer_matching_left.end(); ++it1, ++it2)
-        {
-            std::cout << "Dancer matching money unused during round beginning at " << static_cast<std::string>(it1->first) << ": " << it1->second << "\n";
-            std::cout << "General matching money unused during round beginning at " << static_cast<std::string>(it2->first) << ": " << it2->second << "\n";
-            std::cout << "\n";
-        }
-        IO::write_to_csv(output_folder + "/matching.csv", matching_info.begin(), matching_info.end(), IO::matching_header, IO::matching_row_func);
-        IO::write_to_csv(output_folder + "/dancer_statics.csv", dancer_statistics.begin(), dancer_statistics.end(), IO::statistics_header, IO::statistics_row_func);
-        IO::write_to_csv(output_folder + "/donors.csv", donor_info.begin(), donor_info.end(), IO::donor_header, IO::donor_row_func);
-        IO::write_to_csv(output_folder + "/alumni_donors.csv", alumni_info.begin(), alumni_info.end(), IO::alumni_donor_header, IO::alumni_row_func);
-        IO::write_to_csv(output_folder + "/alumni_statistics.csv", alumni_info.begin(), alumni_info.end(), IO::alumni_statistics_header, IO::alumni_statistics_row);
-        IO::write_to_csv(output_folder + "/hourly_statistics.csv", hour_statistics.begin(), hour_statistics.end(), IO::hourly_statistics_header, IO::hour_statistics_func);
+        write_outputs(m, ops._M_output_folder);
     }
 }
\ No newline at end of file
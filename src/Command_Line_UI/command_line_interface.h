@@ -2,6 +2,7 @@
 #define COMMAND_LINE_HANDLER_H 1
 
 #include <string>
+#include <vector>
 #include <numeric>
 #include <ostream>
 #include "Analysis/basic_types.h"
@@ -14,12 +15,33 @@ namespace Fundraising::Command_Line
     //  --input (-i) the input file name (required)
     //  --output (-o) the output directory (optional)
     //  --num-donations (-n) the number of donations (optional)
+    //  --criteria (-c) the matching criteria file (optional)
+    //  --stream (-s) match donations while reading them (optional)
+    //  --no-snapshot don't read or save a snapshot of the parsed input (optional)
+    //  --follow (-f) check the input for new rows every so many seconds (optional)
+    //  --checkpoint (-k) save the matcher while following and resume from it (optional)
+    //  --what-if (-w) a criteria file to compare against the others, may be repeated (optional)
+    //  --grid (-g) criteria values to try in every combination, may be repeated (optional)
+    //  --optimize (-O) rank the grid by how close it leaves the pools to an unused amount (optional)
     struct opts
     {
         size_t _M_num_donations = 0; 
         std::string _M_input_file;
         std::string _M_output_folder = "output"; 
         std::string _M_criterion_input_file = "";
+        bool _M_stream = false;
+        bool _M_use_snapshot = true;
+        //Seconds between checks for new rows, 0 to read the input once
+        unsigned _M_follow_interval = 0;
+        //Where to save the matcher while following, empty for nowhere
+        std::string _M_checkpoint_file = "";
+        //Criteria files and grid entries for comparing scenarios
+        std::vector<std::string> _M_scenario_files;
+        std::vector<std::string> _M_grid;
+        //Whether to search the grid for the criteria leaving closest 
+        //to _M_target_unused in the pools
+        bool _M_optimize = false;
+        Analysis::donation_val_t _M_target_unused;
     };
 
     opts process_command_line_args(int argc, char** argv);
@@ -0,0 +1,77 @@
+#include "binary_io.h"
+#include <stdexcept>
+
+namespace Fundraising::IO
+{
+    binary_writer::binary_writer(std::ostream& out)
+        : _M_out(out)
+    {
+
+    } //! binary_writer()
+
+    void binary_writer::write_bytes(std::string_view bytes)
+    {
+        _M_out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    } //! write_bytes()
+
+    void binary_writer::write_string(std::string_view str)
+    {
+        write<std::uint64_t>(str.size());
+        write_bytes(str);
+    } //! write_string()
+
+    bool binary_writer::good() const
+    {
+        return _M_out.good();
+    } //! good()
+
+    binary_reader::binary_reader(std::string_view buffer)
+        : _M_buffer(buffer),
+        _M_pos(0)
+    {
+
+    } //! binary_reader()
+
+    std::string_view binary_reader::read_bytes(size_t count)
+    {
+        return std::string_view(take(count), count);
+    } //! read_bytes()
+
+    std::string binary_reader::read_string()
+    {
+        return std::string(read_bytes(read<std::uint64_t>()));
+    } //! read_string()
+
+    size_t binary_reader::remaining() const
+    {
+        return _M_buffer.size() - _M_pos;
+    } //! remaining()
+
+    const char* binary_reader::take(size_t count)
+    {
+        if (count > remaining())
+            throw std::runtime_error("unexpected end of binary data");
+        const char* begin = _M_buffer.data() + _M_pos;
+        _M_pos += count;
+        return begin;
+    } //! take()
+
+    std::uint64_t content_hash(std::string_view contents)
+    {
+        constexpr std::uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ull;
+        std::uint64_t hash = 0xCBF29CE484222325ull ^ contents.size();
+        const char* p = contents.data();
+        size_t size = contents.size();
+        for (; size >= 8; p += 8, size -= 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, p, 8);
+            hash = (hash ^ word)*MULTIPLIER;
+            hash ^= hash >> 29;
+        }
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, p, size);
+        hash = (hash ^ tail)*MULTIPLIER;
+        return hash ^ (hash >> 32);
+    } //! content_hash()
+} //! namespace Fundraising::IO
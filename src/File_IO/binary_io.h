@@ -0,0 +1,116 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace Fundraising::IO
+{
+    //Writes plain values to a binary stream in the byte order of the 
+    //host. Only meant for caches read back on the same machine.
+    class binary_writer
+    {
+        public:
+            //Creates a new writer
+            //@param out the stream to write to. Must be opened in binary mode
+            explicit binary_writer(std::ostream& out);
+
+            //Writes the bytes of a trivially copyable value
+            //@param value the value to write
+            template<typename _Tp>
+            void write(const _Tp& value)
+            {
+                static_assert(std::is_trivially_copyable_v<_Tp>, "binary_writer can only write plain values");
+                _M_out.write(reinterpret_cast<const char*>(&value), sizeof(_Tp));
+            } //! write()
+
+            //Writes the elements of a vector of plain values, without its size
+            //@param values the values to write
+            template<typename _Tp>
+            void write_array(const std::vector<_Tp>& values)
+            {
+                static_assert(std::is_trivially_copyable_v<_Tp>, "binary_writer can only write plain values");
+                _M_out.write(reinterpret_cast<const char*>(values.data()), values.size()*sizeof(_Tp));
+            } //! write_array()
+
+            //Writes raw bytes
+            //@param bytes the bytes to write
+            void write_bytes(std::string_view bytes);
+            //Writes a string preceded by its length
+            //@param str the string to write
+            void write_string(std::string_view str);
+            //Returns whether every write so far succeeded
+            //@return false if the stream failed
+            bool good() const;
+        private:
+            std::ostream& _M_out;
+    }; //! binary_writer
+
+    //Reads plain values written by binary_writer out of a buffer.
+    //Throws a std::runtime_error instead of reading past the end.
+    class binary_reader
+    {
+        public:
+            //Creates a new reader
+            //@param buffer the bytes to read. Must outlive the reader
+            explicit binary_reader(std::string_view buffer);
+
+            //Reads a trivially copyable value
+            //@return the value
+            template<typename _Tp>
+            _Tp read()
+            {
+                static_assert(std::is_trivially_copyable_v<_Tp>, "binary_reader can only read plain values");
+                _Tp value;
+                std::memcpy(&value, take(sizeof(_Tp)), sizeof(_Tp));
+                return value;
+            } //! read()
+
+            //Reads count plain values into a vector
+            //@param count the number of values to read
+            //@return the values
+            template<typename _Tp>
+            std::vector<_Tp> read_array(size_t count)
+            {
+                static_assert(std::is_trivially_copyable_v<_Tp>, "binary_reader can only read plain values");
+                if (count > remaining()/sizeof(_Tp))
+                    take(remaining() + 1);
+                std::vector<_Tp> values(count);
+                if (count > 0)
+                    std::memcpy(values.data(), take(count*sizeof(_Tp)), count*sizeof(_Tp));
+                return values;
+            } //! read_array()
+
+            //Reads raw bytes without copying them
+            //@param count the number of bytes to read
+            //@return view of the bytes in the buffer
+            std::string_view read_bytes(size_t count);
+            //Reads a string written by binary_writer::write_string
+            //@return the string
+            std::string read_string();
+            //Returns the number of bytes left in the buffer
+            //@return the number of unread bytes
+            size_t remaining() const;
+        private:
+            //Moves past count bytes, throwing if there are not enough
+            //@return pointer to the first of the bytes
+            const char* take(size_t count);
+        private:
+            std::string_view _M_buffer;
+            size_t _M_pos;
+    }; //! binary_reader
+
+    //Hashes bytes 8 at a time. Only needs to notice edits, not resist 
+    //deliberate collisions.
+    //@param contents the bytes to hash
+    //@return the hash of the bytes
+    std::uint64_t content_hash(std::string_view contents);
+} //! namespace Fundraising::IO
+
+#endif
@@ -0,0 +1,141 @@
+#include "checkpoint_io.h"
+#include "binary_io.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+namespace Fundraising::IO
+{
+    //Identifies checkpoint files and their layout. Bump the version 
+    //whenever the layout or the matcher's state changes.
+    static constexpr char CHECKPOINT_MAGIC[8] = {'F', 'R', 'C', 'H', 'E', 'C', 'K', 'P'};
+    static constexpr std::uint32_t CHECKPOINT_VERSION = 3;
+    //Written as a number so a checkpoint from a host with another byte 
+    //order is rejected
+    static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    //Bytes hashed at the start of the export and before the checkpoint,
+    //so saving a checkpoint doesn't cost a pass over the whole export
+    static constexpr size_t FINGERPRINT_BYTES = 64*1024;
+
+    //What part of the export, and which criteria, a checkpoint was 
+    //taken against
+    struct fingerprint_t
+    {
+        std::uint64_t _M_head_hash;
+        std::uint64_t _M_tail_hash;
+        std::uint64_t _M_criteria_hash;
+    };
+
+    //Hashes every field of the matching criteria
+    static std::uint64_t criteria_hash(const std::vector<Analysis::matching_criterion_t>& criteria)
+    {
+        std::ostringstream bytes(std::ios::binary);
+        binary_writer out(bytes);
+        out.write<std::uint64_t>(criteria.size());
+        for (const Analysis::matching_criterion_t& round: criteria)
+        {
+            out.write<std::int64_t>(round._M_general_amt.cents());
+            out.write<std::int64_t>(round._M_dancer_amt.cents());
+            out.write<std::int64_t>(round._M_max_per_donor.cents());
+            out.write<std::int64_t>(round._M_max_per_person.cents());
+            out.write<std::int64_t>(round._M_max_per_donation.cents());
+            out.write<std::int64_t>(round._M_start._M_seconds);
+            out.write<std::int64_t>(round._M_end._M_seconds);
+        }
+        return content_hash(bytes.str());
+    } //! criteria_hash()
+
+    //Works out what a checkpoint has to match to be resumed: the first 
+    //and last bytes of the export read so far, and the criteria
+    //@param filename the export
+    //@param offset how far into the export has been read
+    //@param criteria the matching rounds
+    //@param print set to the hashes
+    //@return false if the export is shorter than the offset
+    static bool fingerprint(const std::string& filename, std::uint64_t offset, 
+        const std::vector<Analysis::matching_criterion_t>& criteria, fingerprint_t& print)
+    {
+        mapped_file file(filename);
+        if (file.size() < offset)
+            return false;
+        std::string_view read = file.view().substr(0, offset);
+        size_t window = std::min<size_t>(read.size(), FINGERPRINT_BYTES);
+        print._M_head_hash = content_hash(read.substr(0, window));
+        print._M_tail_hash = content_hash(read.substr(read.size() - window));
+        print._M_criteria_hash = criteria_hash(criteria);
+        return true;
+    } //! fingerprint()
+
+    bool read_checkpoint(const std::string& checkpoint, const std::string& filename, 
+        const std::vector<Analysis::matching_criterion_t>& criteria, Analysis::matcher& m, follow_position_t& position)
+    {
+        if (!std::filesystem::exists(checkpoint))
+            return false;
+        try
+        {
+            mapped_file file(checkpoint);
+            binary_reader in(file.view());
+            if (in.read_bytes(sizeof(CHECKPOINT_MAGIC)) != std::string_view(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) ||
+                in.read<std::uint32_t>() != CHECKPOINT_VERSION || in.read<std::uint32_t>() != BYTE_ORDER_MARK)
+                throw std::runtime_error("not a checkpoint from this version");
+            auto saved_position = in.read<follow_position_t>();
+            auto saved_print = in.read<fingerprint_t>();
+            fingerprint_t print;
+            if (!fingerprint(filename, saved_position._M_offset, criteria, print) || 
+                print._M_head_hash != saved_print._M_head_hash || print._M_tail_hash != saved_print._M_tail_hash)
+                throw std::runtime_error(filename + " has changed since it was taken");
+            if (print._M_criteria_hash != saved_print._M_criteria_hash)
+                throw std::runtime_error("the matching criteria have changed since it was taken");
+            //Load into a spare matcher so m is untouched if the state is damaged
+            Analysis::matcher loaded(std::vector<Analysis::matching_criterion_t>{});
+            loaded.load_state(in);
+            m = std::move(loaded);
+            position = saved_position;
+            return true;
+        } catch (const std::runtime_error& ex)
+        {
+            std::cerr << "Warning: ignoring checkpoint " << checkpoint << ": " << ex.what() << std::endl;
+            return false;
+        }
+    } //! read_checkpoint()
+
+    void write_checkpoint(const std::string& checkpoint, const std::string& filename, 
+        const std::vector<Analysis::matching_criterion_t>& criteria, const Analysis::matcher& m, const follow_position_t& position)
+    {
+        std::string temp_name = checkpoint + ".tmp";
+        try
+        {
+            fingerprint_t print;
+            if (!fingerprint(filename, position._M_offset, criteria, print))
+                throw std::runtime_error(filename + " is shorter than what was read");
+            {
+                std::ofstream file(temp_name, std::ios::binary | std::ios::trunc);
+                if (!file)
+                    throw std::runtime_error("cannot create " + temp_name);
+                binary_writer out(file);
+                out.write_bytes(std::string_view(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)));
+                out.write(CHECKPOINT_VERSION);
+                out.write(BYTE_ORDER_MARK);
+                out.write(position);
+                out.write(print);
+                m.save_state(out);
+                if (!out.good())
+                    throw std::runtime_error("error writing " + temp_name);
+            }
+            //Replace the old checkpoint in one step so a crash while 
+            //saving leaves the last one whole
+            std::filesystem::rename(temp_name, checkpoint);
+        } catch (const std::exception& ex)
+        {
+            std::error_code ignored;
+            std::filesystem::remove(temp_name, ignored);
+            std::cerr << "Warning: could not save checkpoint " << checkpoint << ": " << ex.what() << std::endl;
+        }
+    } //! write_checkpoint()
+} //! namespace Fundraising::IO
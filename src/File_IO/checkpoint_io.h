@@ -0,0 +1,51 @@
+#ifndef CHECKPOINT_IO_H
+#define CHECKPOINT_IO_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Analysis/matching.h"
+
+namespace Fundraising::IO
+{
+    //A checkpoint is the state of a matcher following an export, saved
+    //with how far into the export it had read, so a live run that is
+    //stopped can go on from the last donation it matched. It records a
+    //hash of the start of the export, of the rows just before that
+    //point and of the matching criteria, and is ignored if any changed.
+
+    //How far into a followed export a checkpoint was taken
+    struct follow_position_t
+    {
+        //Offset just past the last row read
+        std::uint64_t _M_offset = 0;
+        //Rows read, including the header
+        std::uint64_t _M_line_no = 0;
+        //Donations matched
+        std::uint64_t _M_num_donations = 0;
+    };
+
+    //Restores a matcher from a checkpoint, if there is one that fits
+    //the export. A damaged checkpoint is skipped with a warning.
+    //@param checkpoint the name of the checkpoint
+    //@param filename the name of the export being followed
+    //@param criteria the matching criteria given for this run
+    //@param m set to the saved matcher. Left alone if false is returned
+    //@param position set to where in the export the checkpoint was taken
+    //@return false if there is no usable checkpoint
+    bool read_checkpoint(const std::string& checkpoint, const std::string& filename, 
+        const std::vector<Analysis::matching_criterion_t>& criteria, Analysis::matcher& m, follow_position_t& position);
+
+    //Saves a matcher to a checkpoint, replacing the old one in one step.
+    //A checkpoint that cannot be written is skipped with a warning.
+    //@param checkpoint the name of the checkpoint
+    //@param filename the name of the export being followed
+    //@param criteria the matching criteria the matcher was created with
+    //@param m the matcher to save
+    //@param position how far into the export the matcher has read
+    void write_checkpoint(const std::string& checkpoint, const std::string& filename, 
+        const std::vector<Analysis::matching_criterion_t>& criteria, const Analysis::matcher& m, const follow_position_t& position);
+} //! namespace Fundraising::IO
+
+#endif
@@ -0,0 +1,229 @@
+#include "compressed_input.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <utility>
+
+#ifdef FUNDRAISING_HAVE_ZLIB
+    #include <zlib.h>
+#endif
+#ifdef FUNDRAISING_HAVE_ZSTD
+    #include <zstd.h>
+#endif
+
+namespace Fundraising::IO
+{
+    //Size of the blocks handed to the reader
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+    //Blocks decompressed ahead of the reader before the thread waits
+    static constexpr size_t MAX_QUEUED_BLOCKS = 4;
+
+    compression_t detect_compression(std::string_view head)
+    {
+        if (head.size() >= 2 && head[0] == '\x1f' && head[1] == '\x8b')
+            return compression_t::GZIP;
+        if (head.size() >= 4 && head.substr(0, 4) == std::string_view("\x28\xb5\x2f\xfd", 4))
+            return compression_t::ZSTD;
+        return compression_t::NONE;
+    } //! detect_compression()
+
+    decompressing_reader::decompressing_reader(std::string filename, compression_t compression)
+        : _M_filename(std::move(filename)),
+        _M_compression(compression),
+        _M_mutex(),
+        _M_changed(),
+        _M_blocks(),
+        _M_finished(false),
+        _M_stopped(false),
+        _M_error(),
+        _M_thread()
+    {
+    #ifndef FUNDRAISING_HAVE_ZLIB
+        if (compression == compression_t::GZIP)
+            throw std::runtime_error("cannot read " + _M_filename + ", this program was built without gzip support");
+    #endif
+    #ifndef FUNDRAISING_HAVE_ZSTD
+        if (compression == compression_t::ZSTD)
+            throw std::runtime_error("cannot read " + _M_filename + ", this program was built without zstd support");
+    #endif
+        _M_thread = std::thread(&decompressing_reader::decompress, this);
+    } //! decompressing_reader()
+
+    decompressing_reader::~decompressing_reader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            _M_stopped = true;
+        }
+        _M_changed.notify_all();
+        _M_thread.join();
+    } //! ~decompressing_reader()
+
+    bool decompressing_reader::next_block(std::string& block)
+    {
+        std::unique_lock<std::mutex> lock(_M_mutex);
+        _M_changed.wait(lock, [this]() {return !_M_blocks.empty() || _M_finished;});
+        if (_M_blocks.empty())
+        {
+            block.clear();
+            if (_M_error)
+                std::rethrow_exception(_M_error);
+            return false;
+        }
+        block = std::move(_M_blocks.front());
+        _M_blocks.pop_front();
+        lock.unlock();
+        _M_changed.notify_all();
+        return true;
+    } //! next_block()
+
+    bool decompressing_reader::push_block(std::string&& block)
+    {
+        std::unique_lock<std::mutex> lock(_M_mutex);
+        _M_changed.wait(lock, [this]() {return _M_blocks.size() < MAX_QUEUED_BLOCKS || _M_stopped;});
+        if (_M_stopped)
+            return false;
+        _M_blocks.push_back(std::move(block));
+        lock.unlock();
+        _M_changed.notify_all();
+        return true;
+    } //! push_block()
+
+    void decompressing_reader::decompress()
+    {
+        try
+        {
+            mapped_file file(_M_filename, mapped_file::access_t::SEQUENTIAL);
+            if (_M_compression == compression_t::GZIP)
+                inflate_gzip(file.view());
+            else if (_M_compression == compression_t::ZSTD)
+                decompress_zstd(file.view());
+            else
+                throw std::runtime_error(_M_filename + " is not compressed");
+        } catch (...)
+        {
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            _M_error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            _M_finished = true;
+        }
+        _M_changed.notify_all();
+    } //! decompress()
+
+#ifdef FUNDRAISING_HAVE_ZLIB
+    void decompressing_reader::inflate_gzip(std::string_view input)
+    {
+        z_stream stream = {};
+        //15 + 32 accepts both gzip and zlib headers
+        if (inflateInit2(&stream, 15 + 32) != Z_OK)
+            throw std::runtime_error("cannot start decompressing " + _M_filename);
+        size_t consumed = 0;
+        bool done = false;
+        try
+        {
+            while (!done)
+            {
+                std::string block(BLOCK_SIZE, '\0');
+                stream.next_out = reinterpret_cast<Bytef*>(block.data());
+                stream.avail_out = static_cast<uInt>(block.size());
+                while (stream.avail_out > 0)
+                {
+                    if (stream.avail_in == 0)
+                    {
+                        size_t chunk = std::min<size_t>(input.size() - consumed, UINT_MAX);
+                        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data() + consumed));
+                        stream.avail_in = static_cast<uInt>(chunk);
+                        consumed += chunk;
+                    }
+                    int status = inflate(&stream, Z_NO_FLUSH);
+                    if (status == Z_STREAM_END)
+                    {
+                        //Archives made with cat or pigz hold several gzip members
+                        done = stream.avail_in == 0 && consumed == input.size();
+                        if (done)
+                            break;
+                        inflateReset(&stream);
+                    }
+                    else if (status == Z_BUF_ERROR && stream.avail_in == 0 && consumed == input.size())
+                        throw std::runtime_error(_M_filename + " is truncated");
+                    else if (status != Z_OK)
+                        throw std::runtime_error("error decompressing " + _M_filename + ": " + 
+                            (stream.msg != nullptr ? stream.msg : "corrupt data"));
+                }
+                block.resize(block.size() - stream.avail_out);
+                if (!block.empty() && !push_block(std::move(block)))
+                    break;
+            }
+        } catch (...)
+        {
+            inflateEnd(&stream);
+            throw;
+        }
+        inflateEnd(&stream);
+    } //! inflate_gzip()
+#else
+    void decompressing_reader::inflate_gzip(std::string_view)
+    {
+        throw std::runtime_error("cannot read " + _M_filename + ", this program was built without gzip support");
+    } //! inflate_gzip()
+#endif
+
+#ifdef FUNDRAISING_HAVE_ZSTD
+    void decompressing_reader::decompress_zstd(std::string_view input)
+    {
+        ZSTD_DStream* stream = ZSTD_createDStream();
+        if (stream == nullptr)
+            throw std::runtime_error("cannot start decompressing " + _M_filename);
+        try
+        {
+            ZSTD_initDStream(stream);
+            ZSTD_inBuffer in = {input.data(), input.size(), 0};
+            size_t last_result = 0;
+            while (in.pos < in.size)
+            {
+                std::string block(BLOCK_SIZE, '\0');
+                ZSTD_outBuffer out = {block.data(), block.size(), 0};
+                while (out.pos < out.size && in.pos < in.size)
+                {
+                    last_result = ZSTD_decompressStream(stream, &out, &in);
+                    if (ZSTD_isError(last_result))
+                        throw std::runtime_error("error decompressing " + _M_filename + ": " + ZSTD_getErrorName(last_result));
+                }
+                block.resize(out.pos);
+                if (!block.empty() && !push_block(std::move(block)))
+                {
+                    ZSTD_freeDStream(stream);
+                    return;
+                }
+            }
+            //Flush whatever the decoder still holds
+            while (last_result != 0)
+            {
+                std::string block(BLOCK_SIZE, '\0');
+                ZSTD_outBuffer out = {block.data(), block.size(), 0};
+                last_result = ZSTD_decompressStream(stream, &out, &in);
+                if (ZSTD_isError(last_result))
+                    throw std::runtime_error("error decompressing " + _M_filename + ": " + ZSTD_getErrorName(last_result));
+                if (out.pos == 0)
+                    throw std::runtime_error(_M_filename + " is truncated");
+                block.resize(out.pos);
+                if (!push_block(std::move(block)))
+                    break;
+            }
+        } catch (...)
+        {
+            ZSTD_freeDStream(stream);
+            throw;
+        }
+        ZSTD_freeDStream(stream);
+    } //! decompress_zstd()
+#else
+    void decompressing_reader::decompress_zstd(std::string_view)
+    {
+        throw std::runtime_error("cannot read " + _M_filename + ", this program was built without zstd support");
+    } //! decompress_zstd()
+#endif
+} //! namespace Fundraising::IO
@@ -0,0 +1,72 @@
+#ifndef COMPRESSED_INPUT_H
+#define COMPRESSED_INPUT_H 1
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace Fundraising::IO
+{
+    //Formats an input file may be compressed with
+    enum class compression_t
+    {
+        NONE,
+        GZIP,
+        ZSTD
+    };
+
+    //Recognizes a compressed file from its first bytes
+    //@param head the start of the file
+    //@return the compression the file uses, or NONE
+    compression_t detect_compression(std::string_view head);
+
+    //Decompresses a file on a thread of its own and hands the output to 
+    //the reader in blocks, so decompression overlaps with parsing and 
+    //the whole file is never held decompressed in memory. gzip needs 
+    //zlib and zstd needs libzstd at build time.
+    class decompressing_reader
+    {
+        public:
+            //Starts decompressing a file. Throws a std::runtime_error if 
+            //this build can't decompress that format.
+            //@param filename the compressed file
+            //@param compression the format of the file
+            decompressing_reader(std::string filename, compression_t compression);
+            //Stops decompressing, even if not all blocks were read
+            ~decompressing_reader();
+
+            //Waits for the next block of decompressed data. Rethrows any
+            //error decompression ran into.
+            //@param block receives the block. Its old contents are discarded
+            //@return false once the whole file has been read
+            bool next_block(std::string& block);
+        private:
+            //Body of the decompression thread
+            void decompress();
+            void inflate_gzip(std::string_view input);
+            void decompress_zstd(std::string_view input);
+            //Hands a block to the reader, waiting while the queue is full
+            //@return false if the reader has stopped
+            bool push_block(std::string&& block);
+        private:
+            std::string _M_filename;
+            compression_t _M_compression;
+            std::mutex _M_mutex;
+            std::condition_variable _M_changed;
+            std::deque<std::string> _M_blocks;
+            bool _M_finished;
+            bool _M_stopped;
+            std::exception_ptr _M_error;
+            std::thread _M_thread;
+
+            decompressing_reader(const decompressing_reader&) = delete;
+            decompressing_reader& operator=(const decompressing_reader&) = delete;
+    }; //! decompressing_reader
+} //! namespace Fundraising::IO
+
+#endif
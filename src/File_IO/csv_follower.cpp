@@ -0,0 +1,121 @@
+#include "csv_follower.h"
+#include "csv_tokenizer.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace Fundraising::IO
+{
+    //Copies part of a file that another program may still be writing. 
+    //The file is copied rather than mapped, so if it is cut short while 
+    //being read the copy just ends early instead of the mapping faulting.
+    //@param filename the file to read
+    //@param offset where to start
+    //@param max_size the most bytes to copy
+    //@param contents set to the bytes copied
+    //@return false if the file ends before offset
+    static bool read_range(const std::string& filename, size_t offset, size_t max_size, std::string& contents)
+    {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in)
+            throw std::runtime_error("Error opening file: " + filename);
+        in.seekg(0, std::ios::end);
+        std::streamoff size = in.tellg();
+        if (size < 0)
+            throw std::runtime_error("Error reading size of file: " + filename);
+        if (static_cast<size_t>(size) < offset)
+            return false;
+        contents.resize(std::min(static_cast<size_t>(size) - offset, max_size));
+        in.seekg(static_cast<std::streamoff>(offset));
+        in.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+        contents.resize(static_cast<size_t>(in.gcount()));
+        return true;
+    } //! read_range()
+
+    csv_follower::csv_follower(std::string filename)
+        : _M_filename(std::move(filename)),
+        _M_offset(0),
+        _M_line_no(0),
+        _M_columns()
+    {
+
+    } //! csv_follower()
+
+    size_t csv_follower::read_new_rows(const std::function<void(const Analysis::donation_t&)>& consume, bool final)
+    {
+        std::string contents;
+        if (!read_range(_M_filename, _M_offset, std::string::npos, contents))
+            throw std::runtime_error(_M_filename + " got shorter while it was being followed");
+        std::string_view appended = contents;
+        //Only go as far as the last complete row
+        size_t end = csv_tokenizer::scan(appended)._M_last_row_end;
+        if (end == std::string_view::npos)
+        {
+            if (!final)
+                return 0;
+            end = appended.size();
+        }
+        else if (final)
+            end = appended.size();
+
+        csv_tokenizer tokenizer(appended.substr(0, end));
+        csv_tokenizer::row_type row;
+        size_t num_read = 0;
+        while (tokenizer.read_row(row))
+        {
+            size_t line_no = _M_line_no + tokenizer.line_no();
+            if (!_M_columns)
+            {
+                _M_columns.emplace(row);
+                continue;
+            }
+            if (row.size() != _M_columns->num_columns())
+                throw std::runtime_error("Number of items in row does not match header. " +
+                    _M_filename + ":L" + std::to_string(line_no));
+            Analysis::donation_t donation = [&]()
+            {
+                try
+                {
+                    return _M_columns->make_donation(row);
+                } catch (const std::runtime_error& ex)
+                {
+                    throw std::runtime_error(std::string(ex.what()) + ". " + _M_filename + ":L" + std::to_string(line_no));
+                }
+            }();
+            consume(donation);
+            ++num_read;
+        }
+        _M_line_no += tokenizer.line_no();
+        _M_offset += end;
+        return num_read;
+    } //! read_new_rows()
+
+    size_t csv_follower::offset() const
+    {
+        return _M_offset;
+    } //! offset()
+
+    size_t csv_follower::line_no() const
+    {
+        return _M_line_no;
+    } //! line_no()
+
+    void csv_follower::resume(size_t offset, size_t line_no)
+    {
+        std::string contents;
+        if (!read_range(_M_filename, 0, offset, contents) || contents.size() < offset)
+            throw std::runtime_error(_M_filename + " got shorter while it was being followed");
+        _M_columns.reset();
+        if (offset > 0)
+        {
+            csv_tokenizer tokenizer(contents);
+            csv_tokenizer::row_type row;
+            if (tokenizer.read_row(row))
+                _M_columns.emplace(row);
+        }
+        _M_offset = offset;
+        _M_line_no = line_no;
+    } //! resume()
+} //! namespace Fundraising::IO
@@ -0,0 +1,56 @@
+#ifndef CSV_FOLLOWER_H
+#define CSV_FOLLOWER_H 1
+
+#include <string>
+#include <optional>
+#include <functional>
+#include <cstddef>
+#include "Analysis/basic_types.h"
+#include "donation_columns.h"
+
+namespace Fundraising::IO
+{
+    //Reads a .csv export that is still being appended to. Remembers how 
+    //far into the file it has read, so each call only parses the rows 
+    //added since the last one.
+    //
+    //A row is only read once the line break ending it has been written, 
+    //so a row that is half written when the file is checked is picked 
+    //up whole on the next call.
+    class csv_follower
+    {
+        public:
+            //Creates a follower that starts at the beginning of a file
+            //@param filename the export to follow
+            explicit csv_follower(std::string filename);
+
+            //Reads the rows appended since the last call and hands each 
+            //donation to consume. Throws a std::runtime_error if the file 
+            //can't be read, a row is invalid or the file got shorter.
+            //@param consume called with every new donation, in file order
+            //@param final whether to also read a last row that no line 
+            //             break has ended yet, because the file is complete
+            //@return the number of donations read
+            size_t read_new_rows(const std::function<void(const Analysis::donation_t&)>& consume, bool final = false);
+            //Returns how far into the file has been read
+            //@return the offset just past the last row read
+            size_t offset() const;
+            //Returns the number of rows read, including the header
+            size_t line_no() const;
+            //Carries on from where an earlier follower of the same file 
+            //stopped, reading the header again. Throws a std::runtime_error 
+            //if the file is shorter than offset.
+            //@param offset the earlier follower's offset()
+            //@param line_no the earlier follower's line_no()
+            void resume(size_t offset, size_t line_no);
+        private:
+            std::string _M_filename;
+            size_t _M_offset;
+            //Rows read so far, including the header
+            size_t _M_line_no;
+            //Resolved once the header row is complete
+            std::optional<donation_columns> _M_columns;
+    }; //! csv_follower
+} //! namespace Fundraising::IO
+
+#endif
@@ -1,67 +1,359 @@
 #include "csv_io.h"
-#include "csvstream.hh"
-#include <map>
+#include "mapped_file.h"
+#include "csv_tokenizer.h"
+#include "donation_columns.h"
+#include "compressed_input.h"
+#include "Utility/thread_pool.h"
+#include <array>
+#include <string_view>
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <optional>
 
 
-namespace Fundraising::IO 
+namespace Fundraising::IO
 {
-    using csvrow_t = std::map<std::string, std::string>;
+    //Smallest piece of a file worth handing to a worker of its own
+    static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+    //Number of bytes read from the start of a file to estimate its row count
+    static constexpr size_t ROW_SIZE_SAMPLE = 1 << 16;
 
-    #define MAP_FIND(map, o) std::find_if(map.begin(), map.end(), [](const std::pair<std::string, std::string>& p){return p.first.find(o) != std::string::npos;})
+    std::vector<std::string_view> split_csv_rows(std::string_view body, size_t num_chunks)
+    {
+        //Candidate split points sit just past a \n, so they can never
+        //be in the middle of a \r\n or right after a backslash
+        std::vector<size_t> bounds = {0};
+        for (size_t k = 1; k < num_chunks; ++k)
+        {
+            size_t guess = std::max(body.size() / num_chunks * k, bounds.back());
+            size_t newline = body.find('\n', guess);
+            if (newline == std::string_view::npos || newline + 1 >= body.size())
+                break;
+            bounds.push_back(newline + 1);
+        }
+        bounds.push_back(body.size());
+        size_t num_pieces = bounds.size() - 1;
 
+        //Whether a candidate is a real row boundary depends on quotes opened
+        //in earlier pieces. Scan each piece for both possible starting states
+        //in parallel, then chain the results together in order.
+        std::vector<std::array<csv_tokenizer::scan_result, 2>> scans(num_pieces);
+        Utility::parallel_for(num_pieces, [&](size_t k)
+        {
+            auto piece = body.substr(bounds[k], bounds[k + 1] - bounds[k]);
+            scans[k][0] = csv_tokenizer::scan(piece, false);
+            scans[k][1] = csv_tokenizer::scan(piece, true);
+        });
+        std::vector<std::string_view> chunks;
+        size_t chunk_begin = 0;
+        bool quoted = false;
+        for (size_t k = 0; k < num_pieces; ++k)
+        {
+            const auto& result = scans[k][quoted ? 1 : 0];
+            size_t piece_size = bounds[k + 1] - bounds[k];
+            if (result._M_last_row_end == piece_size || k + 1 == num_pieces)
+            {
+                chunks.push_back(body.substr(chunk_begin, bounds[k + 1] - chunk_begin));
+                chunk_begin = bounds[k + 1];
+                quoted = false;
+            }
+            else
+            {
+                //The row continues into the next piece
+                quoted = result._M_quoted;
+            }
+        }
+        return chunks;
+    } //! split_csv_rows()
+
+    //Estimates the average size of a row from the start of the file
+    //@param body the rows of the file, starting at a row boundary
+    //@return the average number of bytes per row, or 0 if there are no rows
+    static double average_row_size(std::string_view body)
+    {
+        std::string_view sample = body.substr(0, ROW_SIZE_SAMPLE);
+        csv_tokenizer tokenizer(sample);
+        csv_tokenizer::row_type row;
+        size_t num_rows = 0;
+        size_t num_bytes = 0;
+        while (tokenizer.read_row(row))
+        {
+            //Ignore a row cut off by the end of the sample
+            if (tokenizer.position() == sample.size() && sample.size() < body.size())
+                break;
+            ++num_rows;
+            num_bytes = tokenizer.position();
+        }
+        if (num_rows == 0)
+            return (body.empty()) ? 0.0 : static_cast<double>(body.size());
+        return static_cast<double>(num_bytes)/num_rows;
+    } //! average_row_size()
+
+    //Estimates the number of rows in the rest of a file
+    //@param body the rows of the file, starting at a row boundary
+    //@return the estimated number of rows
+    static size_t estimate_num_rows(std::string_view body)
+    {
+        double row_size = average_row_size(body);
+        if (row_size == 0.0)
+            return 0;
+        return static_cast<size_t>(body.size()/row_size) + 1;
+    } //! estimate_num_rows()
+
+    //Ends the program after a file couldn't be read
+    //@param ex why the file couldn't be read
+    [[noreturn]] static void read_failed(const std::runtime_error& ex)
+    {
+        std::cout << "Error: " << ex.what() << ". Program terminated." << std::endl;
+        exit(EXIT_FAILURE);
+    } //! read_failed()
+
+    //Reads the donations in a compressed .csv file while it is being 
+    //decompressed. Rows can be split across blocks, so whatever follows 
+    //the last complete row of a block waits for the next one. Ends the 
+    //program if the file can't be read, errors thrown by consume are 
+    //passed on.
+    //@param filename the file to read
+    //@param compression the format of the file
+    //@param consume called with every donation in the file
+    //@param max_rows the maximum number of donations to read
+    static void stream_compressed_csv(const std::string& filename, compression_t compression, 
+        const std::function<void(const Analysis::donation_t&)>& consume, size_t max_rows)
+    {
+        std::optional<decompressing_reader> reader;
+        try
+        {
+            reader.emplace(filename, compression);
+        } catch (const std::runtime_error& ex)
+        {
+            read_failed(ex);
+        }
+        std::string pending;
+        std::string block;
+        std::optional<donation_columns> columns;
+        csv_tokenizer::row_type row;
+        size_t line_no = 0;
+        size_t num_rows = 0;
+        bool more = true;
+        while (more && num_rows < max_rows)
+        {
+            try
+            {
+                more = reader->next_block(block);
+            } catch (const std::runtime_error& ex)
+            {
+                read_failed(ex);
+            }
+            if (pending.empty())
+                pending.swap(block);
+            else
+                pending += block;
+            size_t end = (more) ? csv_tokenizer::scan(pending)._M_last_row_end : pending.size();
+            if (end == std::string_view::npos)
+                continue;
+
+            csv_tokenizer tokenizer(std::string_view(pending).substr(0, end));
+            while (num_rows < max_rows && tokenizer.read_row(row))
+            {
+                auto location = [&]() {return filename + ":L" + std::to_string(line_no + tokenizer.line_no());};
+                if (!columns)
+                {
+                    try
+                    {
+                        columns.emplace(row);
+                    } catch (const std::runtime_error& ex)
+                    {
+                        read_failed(ex);
+                    }
+                    continue;
+                }
+                if (row.size() != columns->num_columns())
+                    read_failed(std::runtime_error("Number of items in row does not match header. " + location()));
+                Analysis::donation_t donation = [&]()
+                {
+                    try
+                    {
+                        return columns->make_donation(row);
+                    } catch (const std::runtime_error& ex)
+                    {
+                        read_failed(std::runtime_error(std::string(ex.what()) + ". " + location()));
+                    }
+                }();
+                consume(donation);
+                ++num_rows;
+            }
+            line_no += tokenizer.line_no();
+            pending.erase(0, end);
+        }
+        if (!columns)
+            read_failed(std::runtime_error("error reading header of " + filename));
+    } //! stream_compressed_csv()
+
+    size_t estimate_csv_donations(const std::string& filename)
+    {
+        try
+        {
+            mapped_file file(filename);
+            //The size of a compressed file says little about its rows
+            if (detect_compression(file.view().substr(0, 4)) != compression_t::NONE)
+                return 0;
+            csv_tokenizer tokenizer(file.view());
+            csv_tokenizer::row_type header;
+            if (!tokenizer.read_row(header))
+                return 0;
+            return estimate_num_rows(file.view().substr(tokenizer.position()));
+        } catch (const std::runtime_error&)
+        {
+            //Only a hint, the real read reports the error
+            return 0;
+        }
+    } //! estimate_csv_donations()
 
     std::vector<Analysis::donation_t> read_csv_donations(const std::string& filename, size_t num_donations)
     {
-        try 
+        try
         {
-            std::vector<Analysis::donation_t> donations;
-            csvstream csvin(filename);
-            csvrow_t row; 
-            while (csvin >> row) 
+            //The header and every row are views into the mapped file,
+            //strings are only allocated for the donations themselves
+            mapped_file file(filename);
+            std::string_view contents = file.view();
+            compression_t compression = detect_compression(contents.substr(0, 4));
+            if (compression != compression_t::NONE)
             {
-                //std::cout << row << std::endl;
-                auto date = MAP_FIND(row, "Date")->second;
-                auto time = MAP_FIND(row, "Time")->second;
-                Analysis::date_time_t dt(date, time);
+                std::vector<Analysis::donation_t> donations;
+                donations.reserve(num_donations);
+                stream_compressed_csv(filename, compression, [&donations](const Analysis::donation_t& donation) {donations.push_back(donation);}, 
+                    (num_donations == 0) ? std::numeric_limits<size_t>::max() : num_donations);
+                return donations;
+            }
+            csv_tokenizer header_tokenizer(contents);
+            csv_tokenizer::row_type header;
+            if (!header_tokenizer.read_row(header))
+                throw std::runtime_error("error reading header of " + filename);
+            //Resolve the columns once, rows are read by position
+            donation_columns columns(header);
+            size_t body_offset = header_tokenizer.position();
+            std::string_view body = contents.substr(body_offset);
 
-                auto donor_first_name = row.find("Donor First Name")->second;
-                auto donor_last_name = row.find("Donor Last Name")->second;
-                auto donor_email = row.find("Donor Email")->second;
-                auto donor_phone = row.find("Donor Phone")->second;
-                auto donor_relation = row.find("Donor Relation")->second;
-                auto donation_amt = Analysis::make_donation(row.find("Donation Amount")->second);
-                auto dancer_name = row.find("Dancer Name")->second;
-                auto dancer_email = row.find("Dancer Email")->second;
-                auto dancer_id = row.find("Dancer Peer ID")->second;
-                auto dancer_role = row.find("Dancer Role")->second;
-                auto dancer_house = row.find("Dancer House")->second;
-                auto dancer_team = row.find("Dancer Team")->second;
+            //A row limit means reading from the front, otherwise parse 
+            //large files in pieces on the worker pool
+            size_t num_threads = Utility::thread_pool::instance().size();
+            size_t num_chunks = 1;
+            if (num_threads > 1 && num_donations == 0)
+                num_chunks = std::clamp<size_t>(body.size() / MIN_CHUNK_SIZE, 1, 4 * num_threads);
+            std::vector<std::string_view> chunks = (num_chunks > 1) ? split_csv_rows(body, num_chunks) : std::vector<std::string_view>{body};
+            size_t max_rows = (num_donations == 0) ? std::numeric_limits<size_t>::max() : num_donations;
+            double row_size = average_row_size(body);
 
-                donations.emplace_back(
-                    dt,
-                    donation_amt,
-                    donor_first_name,
-                    donor_last_name,
-                    donor_email,
-                    donor_phone,
-                    donor_relation,
-                    dancer_name,
-                    dancer_email,
-                    dancer_house,
-                    dancer_team,
-                    dancer_role,
-                    dancer_id
-                );
+            //A piece only knows its own row numbers, so a row that can't be 
+            //read is reported once the rows in the pieces before it are known
+            std::vector<std::vector<Analysis::donation_t>> parsed(chunks.size());
+            std::vector<size_t> num_rows(chunks.size(), 0);
+            std::vector<std::optional<std::string>> errors(chunks.size());
+            Utility::parallel_for(chunks.size(), [&](size_t k)
+            {
+                csv_tokenizer tokenizer(chunks[k]);
+                csv_tokenizer::row_type row;
+                if (row_size > 0.0)
+                    parsed[k].reserve(std::min(max_rows, static_cast<size_t>(chunks[k].size()/row_size) + 1));
+                while (parsed[k].size() < max_rows && tokenizer.read_row(row))
+                {
+                    if (row.size() != columns.num_columns())
+                    {
+                        errors[k] = "Number of items in row does not match header";
+                        break;
+                    }
+                    try
+                    {
+                        parsed[k].push_back(columns.make_donation(row));
+                    } catch (const std::runtime_error& ex)
+                    {
+                        errors[k] = ex.what();
+                        break;
+                    }
+                }
+                num_rows[k] = tokenizer.line_no();
+            });
+            size_t line_no = header_tokenizer.line_no();
+            for (size_t k = 0; k < chunks.size(); ++k)
+            {
+                line_no += num_rows[k];
+                if (errors[k])
+                    throw std::runtime_error(*errors[k] + ". " + filename + ":L" + std::to_string(line_no));
             }
+
+            //Stitch the pieces back together in file order
+            if (parsed.size() == 1)
+                return std::move(parsed.front());
+            size_t total = 0;
+            for (const auto& part: parsed)
+                total += part.size();
+            std::vector<Analysis::donation_t> donations;
+            donations.reserve(total);
+            for (auto& part: parsed)
+                std::move(part.begin(), part.end(), std::back_inserter(donations));
             return donations;
-        } catch (const csvstream_exception& ex)
+        } catch (const std::runtime_error& ex)
         {
-            std::cout << "Error: " << filename << " not found. Program terminated." << std::endl;
-            exit(EXIT_FAILURE);
+            read_failed(ex);
         } catch (...)
         {
             std::cout << "Unhandled Exception" << std::endl;
             exit(EXIT_FAILURE);
         }
     }
+
+    void stream_csv_donations(const std::string& filename, const std::function<void(const Analysis::donation_t&)>& consume, 
+        size_t num_donations)
+    {
+        //Errors reading the file end the program. Errors thrown by 
+        //consume are the caller's and are passed on.
+        std::optional<mapped_file> file;
+        compression_t compression = compression_t::NONE;
+        try
+        {
+            file.emplace(filename, mapped_file::access_t::SEQUENTIAL);
+            compression = detect_compression(file->view().substr(0, 4));
+        } catch (const std::runtime_error& ex)
+        {
+            read_failed(ex);
+        }
+        size_t max_rows = (num_donations == 0) ? std::numeric_limits<size_t>::max() : num_donations;
+        if (compression != compression_t::NONE)
+        {
+            stream_compressed_csv(filename, compression, consume, max_rows);
+            return;
+        }
+        csv_tokenizer tokenizer(file->view());
+        csv_tokenizer::row_type row;
+        if (!tokenizer.read_row(row))
+            read_failed(std::runtime_error("error reading header of " + filename));
+        std::optional<donation_columns> columns;
+        try
+        {
+            columns.emplace(row);
+        } catch (const std::runtime_error& ex)
+        {
+            read_failed(ex);
+        }
+        for (size_t i = 0; i < max_rows && tokenizer.read_row(row); ++i)
+        {
+            auto location = [&]() {return filename + ":L" + std::to_string(tokenizer.line_no());};
+            if (row.size() != columns->num_columns())
+                read_failed(std::runtime_error("Number of items in row does not match header. " + location()));
+            Analysis::donation_t donation = [&]()
+            {
+                try
+                {
+                    return columns->make_donation(row);
+                } catch (const std::runtime_error& ex)
+                {
+                    read_failed(std::runtime_error(std::string(ex.what()) + ". " + location()));
+                }
+            }();
+            consume(donation);
+        }
+    }
 }
\ No newline at end of file
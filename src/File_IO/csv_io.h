@@ -2,17 +2,22 @@
 #define CSV_IO_H 
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include "Analysis/basic_types.h"
 #include "Analysis/matching.h"
+#include "Analysis/scenarios.h"
+#include "Analysis/criteria_optimizer.h"
 #include <numeric>
 #include <fstream>
+#include <functional>
+#include <tuple>
 
 namespace Fundraising::IO
 {
     //Lamnda functions for .csv output
     const static std::string matching_header = "Dancer Peer ID,Dancer Name,Dancer Email,Dancer Amount Raised,Dancer Amount Matched,Num Unique Donations";;
-    auto matching_row_func = [](std::ostream& fout, const std::pair<std::string, Analysis::dancer_t>& p)->std::ostream&
+    inline auto matching_row_func = [](std::ostream& fout, const std::pair<std::string, Analysis::dancer_t>& p)->std::ostream&
                                     {
                                         Analysis::dancer_t d = p.second;
                                         fout << d._M_dancer_id << "," << d._M_dancer_name << "," << d._M_dancer_email << ",";
@@ -21,18 +26,19 @@ namespace Fundraising::IO
                                         return fout;
                                     };
     //Dancer statistics ouput
-    const static std::string statistics_header = "Type,Total Fundraised,Mean Fundraising,Median Fundraising,% of Total Fundraising,Number of Participants,% of Total Participants";
-    auto statistics_row_func = [](std::ostream& fout, const std::pair<std::string, Analysis::dancer_statistics_row>& p)->std::ostream&
+    const static std::string statistics_header = "Type,Total Fundraised,Mean Fundraising,Median Fundraising,90th Percentile Fundraising,99th Percentile Fundraising,% of Total Fundraising,Number of Participants,% of Total Participants";
+    inline auto statistics_row_func = [](std::ostream& fout, const std::pair<std::string, Analysis::dancer_statistics_row>& p)->std::ostream&
                                     {
                                         fout << p.first << ",";
                                         auto row = p.second;
                                         fout << std::get<0>(row) << "," << std::get<1>(row) << "," << std::get<2>(row) << ",";
-                                        fout << std::get<3>(row) << "," << std::get<4>(row) << "," << std::get<5>(row);
+                                        fout << std::get<3>(row) << "," << std::get<4>(row) << "," << std::get<5>(row) << ",";
+                                        fout << std::get<6>(row) << "," << std::get<7>(row);
                                         return fout;
                                     };
     //Donor information output
     const static std::string donor_header = "Donor Name,Donor Phone,Donor Email,Amount Donated,Amount Matched";
-    auto donor_row_func = [](std::ostream& fout, const Analysis::donor_t& donor)->std::ostream&
+    inline auto donor_row_func = [](std::ostream& fout, const Analysis::donor_t& donor)->std::ostream&
                                 {
                                     fout << donor._M_donor_first_name << " " << donor._M_donor_last_name << ",";
                                     fout << donor._M_donor_phone << "," << donor._M_donor_email << ",";
@@ -41,7 +47,7 @@ namespace Fundraising::IO
                                 };
     
     const static std::string alumni_donor_header = "Donor Name,Donor Phone,Donor Email,Amount Donated,Amount Matched,Num Donated To";
-    auto alumni_row_func = [](std::ostream& fout, const Analysis::donor_t& donor)->std::ostream&
+    inline auto alumni_row_func = [](std::ostream& fout, const Analysis::donor_t& donor)->std::ostream&
                             {
                                 fout << donor._M_donor_first_name << " " << donor._M_donor_last_name << ",";
                                 fout << donor._M_donor_phone << "," << donor._M_donor_email << ",";
@@ -56,7 +62,7 @@ namespace Fundraising::IO
                             };
     
     const static std::string alumni_statistics_header = "DMUM,Dancer,Leadership";
-    auto alumni_statistics_row = [](std::ostream& fout, Analysis::donor_t donor)->std::ostream&
+    inline auto alumni_statistics_row = [](std::ostream& fout, Analysis::donor_t donor)->std::ostream&
                                 {
                                     fout << std::to_string(donor._M_dancer_ids["DMUM"].size()) << ",";
                                     fout << std::to_string(donor._M_dancer_ids["Dancer"].size()) << ",";
@@ -64,22 +70,87 @@ namespace Fundraising::IO
                                     return fout;
                                 };
 
-    const static std::string hourly_statistics_header = "Hour,Hourly fundraising,mean donation size,median donation size,num donors,num unique donors,number of alumni donors,number of unique alumni donors";
-    auto hour_statistics_func = [](std::ostream& fout,const auto& p)->std::ostream&
+    const static std::string hourly_statistics_header = "Hour,Hourly fundraising,mean donation size,median donation size,90th percentile donation size,99th percentile donation size,num donors,num unique donors,number of alumni donors,number of unique alumni donors";
+    inline auto hour_statistics_func = [](std::ostream& fout,const auto& p)->std::ostream&
                                 {
                                     auto row = p.second;
-                                    Analysis::date_time_t dt = p.first;
-                                    std::get<1>(dt._M_time) = 0;
-                                    std::get<2>(dt._M_time) = 0;
+                                    Analysis::date_time_t dt = p.first.truncate_to_hour();
                                     fout << static_cast<std::string>(dt) << ",";
                                     fout << std::get<0>(row) << "," << std::get<1>(row) << "," << std::get<2>(row)  << ",";
                                     fout << std::get<3>(row) << "," << std::get<4>(row) << "," << std::get<5>(row)  << ",";
-                                    fout << std::get<6>(row);
+                                    fout << std::get<6>(row) << "," << std::get<7>(row) << "," << std::get<8>(row);
                                     return fout;
                                 };
 
+    //What-if scenario comparison output
+    const static std::string scenario_header = "Scenario,Total Raised,Total Matched,Unused General Matching,Unused Dancer Matching";
+    inline auto scenario_row_func = [](std::ostream& fout, const Analysis::scenario_result_t& r)->std::ostream&
+                                {
+                                    fout << r._M_name << "," << r._M_total_raised << "," << r._M_total_matched << ",";
+                                    fout << Analysis::total_unused(r._M_unused_general) << ",";
+                                    fout << Analysis::total_unused(r._M_unused_dancer);
+                                    return fout;
+                                };
+    //Scenario name, round start, unused general matching, unused dancer matching
+    typedef std::tuple<std::string, Analysis::date_time_t, Analysis::donation_val_t, Analysis::donation_val_t> scenario_round_row;
+    const static std::string scenario_round_header = "Scenario,Round Start,Unused General Matching,Unused Dancer Matching";
+    inline auto scenario_round_func = [](std::ostream& fout, const scenario_round_row& row)->std::ostream&
+                                {
+                                    fout << std::get<0>(row) << "," << static_cast<std::string>(std::get<1>(row)) << ",";
+                                    fout << std::get<2>(row) << "," << std::get<3>(row);
+                                    return fout;
+                                };
+    //Scenario name, role, totals for the role
+    typedef std::tuple<std::string, Analysis::symbol_t, Analysis::role_summary_t> scenario_role_row;
+    const static std::string scenario_role_header = "Scenario,Role,Amount Raised,Amount Matched,Number of Participants,Number Matched";
+    inline auto scenario_role_func = [](std::ostream& fout, const scenario_role_row& row)->std::ostream&
+                                {
+                                    const Analysis::role_summary_t& role = std::get<2>(row);
+                                    fout << std::get<0>(row) << "," << std::get<1>(row) << ",";
+                                    fout << role._M_raised << "," << role._M_matched << ",";
+                                    fout << role._M_num_dancers << "," << role._M_num_matched;
+                                    return fout;
+                                };
+
+    //Criteria optimizer output
+    const static std::string optimizer_header = "Candidate,Total Matched,Unused General Matching,Unused Dancer Matching,Distance From Target";
+    inline auto optimizer_row_func = [](std::ostream& fout, const std::string& name, const Analysis::candidate_result_t& r)->std::ostream&
+                                {
+                                    fout << name << "," << r._M_total_matched << "," << r._M_unused_general << ",";
+                                    fout << r._M_unused_dancer << "," << r._M_distance;
+                                    return fout;
+                                };
+
+    //Reads the donations in a .csv file
+    //@param filename the file to read
+    //@param num_donations the maximum number of donations to read, or 0 to read them all
+    //@return the donations in file order
     std::vector<Analysis::donation_t> read_csv_donations(const std::string& filename, size_t num_donations = 0);
 
+    //Reads the donations in a .csv file one at a time, in file order, 
+    //and hands each one to consume without keeping any of them. Ends the
+    //program if the file can't be read, errors thrown by consume are 
+    //passed on to the caller.
+    //@param filename the file to read
+    //@param consume called with every donation in the file
+    //@param num_donations the maximum number of donations to read, or 0 to read them all
+    void stream_csv_donations(const std::string& filename, const std::function<void(const Analysis::donation_t&)>& consume, 
+        size_t num_donations = 0);
+
+    //Estimates the number of donations in a .csv file from its size 
+    //and the length of its first rows
+    //@param filename the file to examine
+    //@return the estimated number of donations, or 0 if the file cannot be read
+    size_t estimate_csv_donations(const std::string& filename);
+
+    //Splits the rows of a .csv file into pieces that each hold whole rows,
+    //so the pieces can be tokenized independently. Line endings inside
+    //quoted fields are never used as split points.
+    //@param body the rows of the file, starting at a row boundary
+    //@param num_chunks the number of pieces wanted
+    //@return the pieces, in file order. There may be fewer than asked for
+    std::vector<std::string_view> split_csv_rows(std::string_view body, size_t num_chunks);
+
     template<typename _IterTp, typename _FuncTp>
     void write_to_csv(const std::string& filename, _IterTp begin, _IterTp end, const std::string& header_row, _FuncTp print_row)
     {
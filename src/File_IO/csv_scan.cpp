@@ -0,0 +1,128 @@
+#include "csv_scan.h"
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define FUNDRAISING_HAVE_SSE2 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        //MSVC allows AVX2 intrinsics in any function
+        #define FUNDRAISING_TARGET_AVX2
+    #else
+        #define FUNDRAISING_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace Fundraising::IO
+{
+    using finder_t = size_t (*)(const char*, const char*, char);
+
+    static size_t find_field_break_scalar(const char* begin, const char* end, char delimiter)
+    {
+        for (const char* p = begin; p < end; ++p)
+        {
+            char c = *p;
+            if (c == delimiter || c == '"' || c == '\\' || c == '\n' || c == '\r')
+                return static_cast<size_t>(p - begin);
+        }
+        return static_cast<size_t>(end - begin);
+    } //! find_field_break_scalar()
+
+#ifdef FUNDRAISING_HAVE_SSE2
+    static unsigned count_trailing_zeros(std::uint32_t mask)
+    {
+    #ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+    #else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+    #endif
+    } //! count_trailing_zeros()
+
+    static size_t find_field_break_sse2(const char* begin, const char* end, char delimiter)
+    {
+        const __m128i delimiters = _mm_set1_epi8(delimiter);
+        const __m128i quotes = _mm_set1_epi8('"');
+        const __m128i backslashes = _mm_set1_epi8('\\');
+        const __m128i newlines = _mm_set1_epi8('\n');
+        const __m128i returns = _mm_set1_epi8('\r');
+        const char* p = begin;
+        for (; end - p >= 16; p += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block, delimiters), _mm_cmpeq_epi8(block, quotes)),
+                _mm_or_si128(_mm_cmpeq_epi8(block, backslashes),
+                    _mm_or_si128(_mm_cmpeq_epi8(block, newlines), _mm_cmpeq_epi8(block, returns))));
+            std::uint32_t mask = static_cast<std::uint32_t>(_mm_movemask_epi8(hits));
+            if (mask != 0)
+                return static_cast<size_t>(p - begin) + count_trailing_zeros(mask);
+        }
+        return static_cast<size_t>(p - begin) + find_field_break_scalar(p, end, delimiter);
+    } //! find_field_break_sse2()
+
+    FUNDRAISING_TARGET_AVX2
+    static size_t find_field_break_avx2(const char* begin, const char* end, char delimiter)
+    {
+        const __m256i delimiters = _mm256_set1_epi8(delimiter);
+        const __m256i quotes = _mm256_set1_epi8('"');
+        const __m256i backslashes = _mm256_set1_epi8('\\');
+        const __m256i newlines = _mm256_set1_epi8('\n');
+        const __m256i returns = _mm256_set1_epi8('\r');
+        const char* p = begin;
+        for (; end - p >= 32; p += 32)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i hits = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, delimiters), _mm256_cmpeq_epi8(block, quotes)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, backslashes),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(block, newlines), _mm256_cmpeq_epi8(block, returns))));
+            std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(hits));
+            if (mask != 0)
+                return static_cast<size_t>(p - begin) + count_trailing_zeros(mask);
+        }
+        //Finish the tail 16 bytes at a time
+        return static_cast<size_t>(p - begin) + find_field_break_sse2(p, end, delimiter);
+    } //! find_field_break_avx2()
+
+    //Checks both that the processor has AVX2 and that the OS saves its registers
+    static bool cpu_supports_avx2()
+    {
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        if (!os_saves_ymm)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    #endif
+    } //! cpu_supports_avx2()
+#endif
+
+    //Picks the widest implementation the processor supports
+    static finder_t select_finder()
+    {
+    #ifdef FUNDRAISING_HAVE_SSE2
+        if (cpu_supports_avx2())
+            return find_field_break_avx2;
+        return find_field_break_sse2;
+    #else
+        return find_field_break_scalar;
+    #endif
+    } //! select_finder()
+
+    static const finder_t FINDER = select_finder();
+
+    size_t find_field_break(const char* begin, const char* end, char delimiter)
+    {
+        return FINDER(begin, end, delimiter);
+    } //! find_field_break()
+} //! namespace Fundraising::IO
@@ -0,0 +1,19 @@
+#ifndef CSV_SCAN_H
+#define CSV_SCAN_H 1
+
+#include <cstddef>
+
+namespace Fundraising::IO
+{
+    //Finds the end of a run of plain characters in an unquoted CSV field,
+    //that is the first delimiter, double quote, backslash, \n or \r.
+    //Checks 32 or 16 bytes at a time with AVX2 or SSE2 when the processor
+    //supports them, chosen once at runtime, and one byte at a time otherwise.
+    //@param begin the first character to check
+    //@param end one past the last character to check
+    //@param delimiter the character separating fields
+    //@return the offset of the first special character from begin, or end - begin if there is none
+    size_t find_field_break(const char* begin, const char* end, char delimiter);
+} //! namespace Fundraising::IO
+
+#endif
@@ -0,0 +1,171 @@
+#include "csv_tokenizer.h"
+#include "csv_scan.h"
+
+namespace Fundraising::IO
+{
+    csv_tokenizer::csv_tokenizer(std::string_view buffer, char delimiter)
+        : _M_buffer(buffer),
+        _M_delimiter(delimiter),
+        _M_pos(0),
+        _M_line_no(0),
+        _M_scratch(),
+        _M_fields()
+    {
+
+    } //! csv_tokenizer()
+
+    bool csv_tokenizer::read_row(row_type& row)
+    {
+        row.clear();
+        _M_fields.clear();
+        _M_scratch.clear();
+
+        const char* const buffer = _M_buffer.data();
+        const size_t size = _M_buffer.size();
+        size_t i = _M_pos;
+        //Skip blank lines
+        while (i < size && (buffer[i] == '\n' || buffer[i] == '\r'))
+            ++i;
+        if (i >= size)
+        {
+            _M_pos = size;
+            return false;
+        }
+
+        field_t field = {false, i, 0};
+        //Appends characters to the current field. Unless the field has moved
+        //to scratch space, the characters are already in place in the buffer.
+        auto append = [&](size_t from, size_t count)
+        {
+            if (field._M_in_scratch)
+                _M_scratch.append(buffer + from, count);
+            field._M_length += count;
+        };
+        bool quoted = false;
+        while (i < size)
+        {
+            char c = buffer[i];
+            if (quoted)
+            {
+                if (c == '"')
+                {
+                    quoted = false;
+                    ++i;
+                }
+                else if (c == '\\')
+                {
+                    //Keep the backslash and whatever it escapes
+                    size_t count = (i + 1 < size) ? 2 : 1;
+                    append(i, count);
+                    i += count;
+                }
+                else
+                {
+                    append(i, 1);
+                    ++i;
+                }
+                continue;
+            }
+            //Most fields are short and unquoted, so skip over plain
+            //characters in bulk before looking at the one that stopped us
+            size_t run = find_field_break(buffer + i, buffer + size, _M_delimiter);
+            if (run > 0)
+            {
+                append(i, run);
+                i += run;
+                if (i >= size)
+                    break;
+                c = buffer[i];
+            }
+            if (c == _M_delimiter)
+            {
+                _M_fields.push_back(field);
+                field = {false, i + 1, 0};
+                ++i;
+            }
+            else if (c == '"')
+            {
+                //The quote is dropped, so the field can no longer be
+                //a plain slice of the buffer
+                if (!field._M_in_scratch)
+                {
+                    size_t raw_begin = field._M_begin;
+                    field._M_in_scratch = true;
+                    field._M_begin = _M_scratch.size();
+                    _M_scratch.append(buffer + raw_begin, field._M_length);
+                }
+                quoted = true;
+                ++i;
+            }
+            else if (c == '\\')
+            {
+                size_t count = (i + 1 < size) ? 2 : 1;
+                append(i, count);
+                i += count;
+            }
+            else if (c == '\n' || c == '\r')
+            {
+                ++i;
+                //Handle Windows line endings
+                if (c == '\r' && i < size && buffer[i] == '\n')
+                    ++i;
+                break;
+            }
+            else
+            {
+                append(i, 1);
+                ++i;
+            }
+        }
+        _M_fields.push_back(field);
+        _M_pos = i;
+        ++_M_line_no;
+
+        //Scratch space is no longer growing, so views into it are safe
+        row.reserve(_M_fields.size());
+        for (const auto& f: _M_fields)
+        {
+            const char* begin = f._M_in_scratch ? _M_scratch.data() + f._M_begin : buffer + f._M_begin;
+            row.emplace_back(begin, f._M_length);
+        }
+        return true;
+    } //! read_row()
+
+    size_t csv_tokenizer::line_no() const
+    {
+        return _M_line_no;
+    } //! line_no()
+
+    size_t csv_tokenizer::position() const
+    {
+        return _M_pos;
+    } //! position()
+
+    csv_tokenizer::scan_result csv_tokenizer::scan(std::string_view text, bool quoted)
+    {
+        scan_result result = {quoted, false, std::string_view::npos};
+        const char* const begin = text.data();
+        const size_t size = text.size();
+        for (size_t i = 0; i < size; ++i)
+        {
+            //Outside of quotes only quotes, backslashes and line endings 
+            //matter, so jump straight to the next one
+            if (!result._M_quoted && !result._M_escaped)
+            {
+                i += find_field_break(begin + i, begin + size, '"');
+                if (i >= size)
+                    break;
+            }
+            char c = begin[i];
+            if (result._M_escaped)
+                result._M_escaped = false;
+            else if (c == '\\')
+                result._M_escaped = true;
+            else if (c == '"')
+                result._M_quoted = !result._M_quoted;
+            else if (!result._M_quoted && (c == '\n' || c == '\r'))
+                result._M_last_row_end = i + 1;
+        }
+        return result;
+    } //! scan()
+} //! namespace Fundraising::IO
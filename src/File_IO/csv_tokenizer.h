@@ -0,0 +1,78 @@
+#ifndef CSV_TOKENIZER_H
+#define CSV_TOKENIZER_H 1
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+namespace Fundraising::IO
+{
+    //Splits a buffer holding CSV text into rows of fields without
+    //copying it. Follows the same rules as csvstream: a double quote
+    //toggles quoting and is dropped from the field, a backslash is kept
+    //and escapes the character after it, and a row ends at \n, \r or \r\n
+    //outside of quotes. Blank lines are skipped.
+    //
+    //Fields point directly into the buffer unless they contained quotes,
+    //in which case they point into scratch space owned by the tokenizer.
+    //Either way a row is only valid until the next call to read_row.
+    class csv_tokenizer
+    {
+        public:
+            using row_type = std::vector<std::string_view>;
+
+            //Quoting state after scanning a piece of CSV text
+            struct scan_result
+            {
+                //Whether the scan ended inside quotes
+                bool _M_quoted;
+                //Whether the scan ended right after a backslash
+                bool _M_escaped;
+                //Offset just past the last line ending outside of quotes,
+                //or npos if there was none
+                size_t _M_last_row_end;
+            };
+
+            //Creates a new tokenizer over the specified buffer
+            //@param buffer the CSV text. Must outlive the tokenizer
+            //@param delimiter the character separating fields
+            csv_tokenizer(std::string_view buffer, char delimiter = ',');
+
+            //Reads the next row from the buffer
+            //@param row receives the fields of the row
+            //@return false if there are no rows left
+            bool read_row(row_type& row);
+            //Returns the number of rows read so far, including the header
+            //@return the number of rows read
+            size_t line_no() const;
+            //Returns the offset in the buffer where the next row begins
+            //@return the current offset into the buffer
+            size_t position() const;
+
+            //Follows the quoting rules over a piece of CSV text without
+            //tokenizing it, to find where rows end
+            //@param text the text to scan
+            //@param quoted whether the text starts inside quotes
+            //@return the quoting state at the end of the text
+            static scan_result scan(std::string_view text, bool quoted = false);
+        private:
+            //Location of a field either in the buffer or in _M_scratch
+            struct field_t
+            {
+                bool _M_in_scratch;
+                size_t _M_begin;
+                size_t _M_length;
+            };
+        private:
+            std::string_view _M_buffer;
+            char _M_delimiter;
+            size_t _M_pos;
+            size_t _M_line_no;
+            //Unquoted copies of fields that contained quotes
+            std::string _M_scratch;
+            std::vector<field_t> _M_fields;
+    }; //! csv_tokenizer
+} //! namespace Fundraising::IO
+
+#endif
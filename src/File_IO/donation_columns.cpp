@@ -0,0 +1,114 @@
+#include "donation_columns.h"
+#include <stdexcept>
+
+namespace Fundraising::IO
+{
+    const std::array<std::string_view, donation_columns::NUM_FIELDS> donation_columns::FIELD_NAMES = {
+        "Date",
+        "Time",
+        "Donor First Name",
+        "Donor Last Name",
+        "Donor Email",
+        "Donor Phone",
+        "Donor Relation",
+        "Donation Amount",
+        "Dancer Name",
+        "Dancer Email",
+        "Dancer Peer ID",
+        "Dancer Role",
+        "Dancer House",
+        "Dancer Team"
+    };
+
+    //Strips surrounding whitespace and a UTF-8 byte order mark, which
+    //spreadsheet programs like to put in front of the first column name
+    static std::string_view clean_column_name(std::string_view name)
+    {
+        constexpr std::string_view BOM = "\xEF\xBB\xBF";
+        if (name.substr(0, BOM.size()) == BOM)
+            name.remove_prefix(BOM.size());
+        while (!name.empty() && (name.front() == ' ' || name.front() == '\t'))
+            name.remove_prefix(1);
+        while (!name.empty() && (name.back() == ' ' || name.back() == '\t'))
+            name.remove_suffix(1);
+        return name;
+    } //! clean_column_name()
+
+    donation_columns::donation_columns(const std::vector<std::string_view>& header)
+        : _M_index(),
+        _M_num_columns(header.size())
+    {
+        std::vector<std::string_view> names;
+        names.reserve(header.size());
+        for (const auto& name: header)
+            names.push_back(clean_column_name(name));
+
+        std::string missing;
+        std::string duplicated;
+        for (size_t f = 0; f < NUM_FIELDS; ++f)
+        {
+            std::vector<size_t> matches;
+            for (size_t i = 0; i < names.size(); ++i)
+            {
+                if (names[i] == FIELD_NAMES[f])
+                    matches.push_back(i);
+            }
+            //The timestamp columns go by several names across exports
+            if (matches.empty() && (f == DATE || f == TIME))
+            {
+                for (size_t i = 0; i < names.size(); ++i)
+                {
+                    if (names[i].find(FIELD_NAMES[f]) != std::string_view::npos)
+                        matches.push_back(i);
+                }
+            }
+            if (matches.empty())
+                missing += (missing.empty() ? "" : ", ") + std::string(FIELD_NAMES[f]);
+            else if (matches.size() > 1)
+                duplicated += (duplicated.empty() ? "" : ", ") + std::string(FIELD_NAMES[f]);
+            else
+                _M_index[f] = matches.front();
+        }
+        if (!missing.empty() || !duplicated.empty())
+        {
+            std::string msg = "Invalid donation header";
+            if (!missing.empty())
+                msg += ". Missing column(s): " + missing;
+            if (!duplicated.empty())
+                msg += ". Duplicate column(s): " + duplicated;
+            throw std::runtime_error(msg);
+        }
+    } //! donation_columns()
+
+    size_t donation_columns::num_columns() const
+    {
+        return _M_num_columns;
+    } //! num_columns()
+
+    size_t donation_columns::time_column() const
+    {
+        return _M_index[TIME];
+    } //! time_column()
+
+    Analysis::donation_t donation_columns::make_donation(const std::vector<std::string_view>& row) const
+    {
+        auto field = [&](field_t f) {return std::string(row[_M_index[f]]);};
+        //Low cardinality columns are interned straight from the row
+        auto symbol = [&](field_t f) {return Analysis::symbol_t(row[_M_index[f]]);};
+        return Analysis::donation_t(
+            Analysis::date_time_t(row[_M_index[DATE]], row[_M_index[TIME]]),
+            Analysis::make_donation(row[_M_index[DONATION_AMOUNT]]),
+            field(DONOR_FIRST_NAME),
+            field(DONOR_LAST_NAME),
+            field(DONOR_EMAIL),
+            field(DONOR_PHONE),
+            symbol(DONOR_RELATION),
+            field(DANCER_NAME),
+            field(DANCER_EMAIL),
+            symbol(DANCER_HOUSE),
+            symbol(DANCER_TEAM),
+            symbol(DANCER_ROLE),
+            field(DANCER_PEER_ID)
+        );
+    } //! make_donation()
+} //! namespace Fundraising::IO
@@ -0,0 +1,64 @@
+#ifndef DONATION_COLUMNS_H
+#define DONATION_COLUMNS_H 1
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include "Analysis/basic_types.h"
+
+namespace Fundraising::IO
+{
+    //Binds the fields of a donation to column positions in an export.
+    //The header is resolved once, after which rows are read by position.
+    //
+    //Every field is looked up by its exact column name except the
+    //date and time of the donation, which may be any column whose
+    //name contains "Date" or "Time" (e.g. "Donation Date").
+    class donation_columns
+    {
+        public:
+            //Resolves the donation fields against the header row. Throws a
+            //std::runtime_error naming every missing or duplicated column.
+            //@param header the column names, in order
+            explicit donation_columns(const std::vector<std::string_view>& header);
+
+            //Returns the number of columns in the header
+            //@return the number of fields each row must have
+            size_t num_columns() const;
+            //Returns the position of the column the time of day is read from
+            //@return the index of the time column
+            size_t time_column() const;
+            //Builds a donation from one row of the export
+            //@param row the fields of the row, in header order
+            //@return the donation described by the row
+            Analysis::donation_t make_donation(const std::vector<std::string_view>& row) const;
+        private:
+            enum field_t
+            {
+                DATE,
+                TIME,
+                DONOR_FIRST_NAME,
+                DONOR_LAST_NAME,
+                DONOR_EMAIL,
+                DONOR_PHONE,
+                DONOR_RELATION,
+                DONATION_AMOUNT,
+                DANCER_NAME,
+                DANCER_EMAIL,
+                DANCER_PEER_ID,
+                DANCER_ROLE,
+                DANCER_HOUSE,
+                DANCER_TEAM,
+                NUM_FIELDS
+            };
+            //Column name of each field
+            static const std::array<std::string_view, NUM_FIELDS> FIELD_NAMES;
+        private:
+            std::array<size_t, NUM_FIELDS> _M_index;
+            size_t _M_num_columns;
+    }; //! donation_columns
+} //! namespace Fundraising::IO
+
+#endif
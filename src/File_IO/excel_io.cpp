@@ -0,0 +1,180 @@
+#include "excel_io.h"
+#include "donation_columns.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+#ifdef FUNDRAISING_HAVE_XLNT
+    #include <xlnt/cell/cell.hpp>
+    #include <xlnt/utils/datetime.hpp>
+    #include <xlnt/workbook/streaming_workbook_reader.hpp>
+#endif
+
+namespace Fundraising::IO
+{
+    bool is_excel_file(const std::string& filename)
+    {
+        const std::string extension = ".xlsx";
+        if (filename.size() < extension.size())
+            return false;
+        return std::equal(extension.begin(), extension.end(), filename.end() - extension.size(), 
+            [](char a, char b) {return a == std::tolower(static_cast<unsigned char>(b));});
+    } //! is_excel_file()
+
+#ifdef FUNDRAISING_HAVE_XLNT
+    //Writes a cell the way the .csv exports write the same value, so 
+    //donations can be built from it by the same code
+    //@param cell the cell to convert
+    //@param time_field whether the cell is read as the time of a donation
+    //@return the text of the cell
+    static std::string cell_text(const xlnt::cell& cell, bool time_field)
+    {
+        if (!cell.has_value())
+            return std::string();
+        char buffer[32];
+        if (cell.is_date())
+        {
+            //The time column is always written as a time of day, so a 
+            //full date and time keeps only the time and midnight is 
+            //00:00:00. Elsewhere a value under a day is a time of day and 
+            //anything else a date.
+            double serial = cell.value<double>();
+            xlnt::datetime dt = cell.value<xlnt::datetime>();
+            if (serial < 1.0 || time_field)
+                std::snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", dt.hour, dt.minute, dt.second);
+            else
+                std::snprintf(buffer, sizeof(buffer), "%02d/%02d/%04d", dt.month, dt.day, dt.year);
+            return buffer;
+        }
+        if (cell.data_type() == xlnt::cell::type::number)
+        {
+            //Phone numbers are often stored as numbers, don't let them 
+            //turn into scientific notation
+            double value = cell.value<double>();
+            if (value == std::floor(value) && std::fabs(value) < 1e15)
+                std::snprintf(buffer, sizeof(buffer), "%.0f", value);
+            else
+                std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+            return buffer;
+        }
+        return cell.to_string();
+    } //! cell_text()
+
+    //Ends the program after a file couldn't be read
+    //@param ex why the file couldn't be read
+    [[noreturn]] static void read_failed(const std::runtime_error& ex)
+    {
+        std::cout << "Error: " << ex.what() << ". Program terminated." << std::endl;
+        exit(EXIT_FAILURE);
+    } //! read_failed()
+
+    void stream_excel_donations(const std::string& filename, const std::function<void(const Analysis::donation_t&)>& consume, 
+        size_t num_donations)
+    {
+        //Errors reading the file end the program. Errors thrown by 
+        //consume are the caller's and are passed on.
+        xlnt::streaming_workbook_reader reader;
+        try
+        {
+            reader.open(filename);
+            std::vector<std::string> titles = reader.sheet_titles();
+            if (titles.empty())
+                throw std::runtime_error(filename + " has no worksheets");
+            reader.begin_worksheet(titles.front());
+        } catch (const std::runtime_error& ex)
+        {
+            read_failed(ex);
+        }
+
+        size_t max_rows = (num_donations == 0) ? std::numeric_limits<size_t>::max() : num_donations;
+        size_t num_rows = 0;
+        std::optional<donation_columns> columns;
+        std::vector<std::string> values;
+        std::vector<std::string_view> row;
+        //Cells arrive in row order and empty cells are left out, so 
+        //collect a row until the next one starts
+        //@return the donation in the row, or nothing for the header
+        auto finish_row = [&](xlnt::row_t row_index)->std::optional<Analysis::donation_t>
+        {
+            auto location = [&]() {return filename + ":L" + std::to_string(row_index);};
+            if (columns && values.size() > columns->num_columns())
+                throw std::runtime_error("Number of items in row does not match header. " + location());
+            if (columns)
+                values.resize(columns->num_columns());
+            row.assign(values.begin(), values.end());
+            std::optional<Analysis::donation_t> donation;
+            if (!columns)
+                columns.emplace(row);
+            else
+            {
+                try
+                {
+                    donation = columns->make_donation(row);
+                } catch (const std::runtime_error& ex)
+                {
+                    throw std::runtime_error(std::string(ex.what()) + ". " + location());
+                }
+            }
+            values.clear();
+            return donation;
+        };
+        xlnt::row_t current_row = 0;
+        bool in_row = false;
+        bool more = true;
+        while (more && num_rows < max_rows)
+        {
+            std::optional<Analysis::donation_t> donation;
+            try
+            {
+                more = reader.has_cell();
+                if (more)
+                {
+                    xlnt::cell cell = reader.read_cell();
+                    if (in_row && cell.row() != current_row)
+                        donation = finish_row(current_row);
+                    current_row = cell.row();
+                    in_row = true;
+                    size_t column = cell.column_index() - 1;
+                    if (values.size() <= column)
+                        values.resize(column + 1);
+                    values[column] = cell_text(cell, columns && column == columns->time_column());
+                }
+                else if (in_row && !values.empty())
+                    donation = finish_row(current_row);
+            } catch (const std::runtime_error& ex)
+            {
+                read_failed(ex);
+            }
+            if (donation)
+            {
+                consume(*donation);
+                ++num_rows;
+            }
+        }
+        if (!columns)
+            read_failed(std::runtime_error("error reading header of " + filename));
+    } //! stream_excel_donations()
+#else
+    void stream_excel_donations(const std::string& filename, const std::function<void(const Analysis::donation_t&)>&, 
+        size_t)
+    {
+        std::cout << "Error: cannot read " << filename << ", this program was built without .xlsx support. Program terminated." << std::endl;
+        exit(EXIT_FAILURE);
+    } //! stream_excel_donations()
+#endif
+
+    std::vector<Analysis::donation_t> read_excel_donations(const std::string& filename, size_t num_donations)
+    {
+        std::vector<Analysis::donation_t> donations;
+        donations.reserve(num_donations);
+        stream_excel_donations(filename, [&donations](const Analysis::donation_t& donation) {donations.push_back(donation);}, 
+            num_donations);
+        return donations;
+    } //! read_excel_donations()
+} //! namespace Fundraising::IO
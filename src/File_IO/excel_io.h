@@ -0,0 +1,35 @@
+#ifndef EXCEL_IO_H
+#define EXCEL_IO_H 1
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "Analysis/basic_types.h"
+
+namespace Fundraising::IO
+{
+    //Returns whether a file should be read as an Excel workbook
+    //@param filename the name of the file
+    //@return true if the file has an .xlsx extension
+    bool is_excel_file(const std::string& filename);
+
+    //Reads the donations on the first worksheet of an .xlsx file. The 
+    //first row holds the same column names as the .csv exports.
+    //@param filename the file to read
+    //@param num_donations the maximum number of donations to read, or 0 to read them all
+    //@return the donations in sheet order
+    std::vector<Analysis::donation_t> read_excel_donations(const std::string& filename, size_t num_donations = 0);
+
+    //Reads the donations on the first worksheet of an .xlsx file one row 
+    //at a time and hands each one to consume. The workbook is streamed, 
+    //so its object model is never built in memory. Ends the program if 
+    //the file can't be read, errors thrown by consume are passed on to 
+    //the caller.
+    //@param filename the file to read
+    //@param consume called with every donation in the sheet
+    //@param num_donations the maximum number of donations to read, or 0 to read them all
+    void stream_excel_donations(const std::string& filename, const std::function<void(const Analysis::donation_t&)>& consume, 
+        size_t num_donations = 0);
+} //! namespace Fundraising::IO
+
+#endif
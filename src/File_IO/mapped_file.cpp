@@ -0,0 +1,176 @@
+#include "mapped_file.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Fundraising::IO
+{
+#ifdef _WIN32
+    mapped_file::mapped_file(const std::string& filename, access_t access)
+        : _M_data(nullptr),
+        _M_size(0),
+        _M_file_handle(INVALID_HANDLE_VALUE),
+        _M_mapping_handle(nullptr)
+    {
+        DWORD flags = (access == access_t::SEQUENTIAL) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr, OPEN_EXISTING, flags, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Error opening file: " + filename);
+        _M_file_handle = file;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            unmap();
+            throw std::runtime_error("Error reading size of file: " + filename);
+        }
+        _M_size = static_cast<size_t>(size.QuadPart);
+        //Windows refuses to map empty files
+        if (_M_size == 0)
+            return;
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            unmap();
+            throw std::runtime_error("Error mapping file: " + filename);
+        }
+        _M_mapping_handle = mapping;
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr)
+        {
+            unmap();
+            throw std::runtime_error("Error mapping file: " + filename);
+        }
+        _M_data = static_cast<const char*>(view);
+    } //! mapped_file()
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept
+        : _M_data(std::exchange(other._M_data, nullptr)),
+        _M_size(std::exchange(other._M_size, 0)),
+        _M_file_handle(std::exchange(other._M_file_handle, INVALID_HANDLE_VALUE)),
+        _M_mapping_handle(std::exchange(other._M_mapping_handle, nullptr))
+    {
+
+    } //! mapped_file()
+
+    mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            _M_data = std::exchange(other._M_data, nullptr);
+            _M_size = std::exchange(other._M_size, 0);
+            _M_file_handle = std::exchange(other._M_file_handle, INVALID_HANDLE_VALUE);
+            _M_mapping_handle = std::exchange(other._M_mapping_handle, nullptr);
+        }
+        return *this;
+    } //! operator=
+
+    void mapped_file::unmap()
+    {
+        if (_M_data != nullptr)
+            UnmapViewOfFile(_M_data);
+        if (_M_mapping_handle != nullptr)
+            CloseHandle(_M_mapping_handle);
+        if (_M_file_handle != INVALID_HANDLE_VALUE)
+            CloseHandle(_M_file_handle);
+        _M_data = nullptr;
+        _M_size = 0;
+        _M_mapping_handle = nullptr;
+        _M_file_handle = INVALID_HANDLE_VALUE;
+    } //! unmap()
+#else
+    mapped_file::mapped_file(const std::string& filename, access_t access)
+        : _M_data(nullptr),
+        _M_size(0),
+        _M_fd(-1)
+    {
+        _M_fd = ::open(filename.c_str(), O_RDONLY);
+        if (_M_fd < 0)
+            throw std::runtime_error("Error opening file: " + filename);
+        struct stat st;
+        if (::fstat(_M_fd, &st) != 0)
+        {
+            unmap();
+            throw std::runtime_error("Error reading size of file: " + filename);
+        }
+        _M_size = static_cast<size_t>(st.st_size);
+        //mmap refuses zero length mappings
+        if (_M_size == 0)
+            return;
+        void* view = ::mmap(nullptr, _M_size, PROT_READ, MAP_PRIVATE, _M_fd, 0);
+        if (view == MAP_FAILED)
+        {
+            unmap();
+            throw std::runtime_error("Error mapping file: " + filename);
+        }
+        if (access == access_t::SEQUENTIAL)
+            ::madvise(view, _M_size, MADV_SEQUENTIAL);
+        _M_data = static_cast<const char*>(view);
+    } //! mapped_file()
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept
+        : _M_data(std::exchange(other._M_data, nullptr)),
+        _M_size(std::exchange(other._M_size, 0)),
+        _M_fd(std::exchange(other._M_fd, -1))
+    {
+
+    } //! mapped_file()
+
+    mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            _M_data = std::exchange(other._M_data, nullptr);
+            _M_size = std::exchange(other._M_size, 0);
+            _M_fd = std::exchange(other._M_fd, -1);
+        }
+        return *this;
+    } //! operator=
+
+    void mapped_file::unmap()
+    {
+        if (_M_data != nullptr)
+            ::munmap(const_cast<char*>(_M_data), _M_size);
+        if (_M_fd >= 0)
+            ::close(_M_fd);
+        _M_data = nullptr;
+        _M_size = 0;
+        _M_fd = -1;
+    } //! unmap()
+#endif
+
+    mapped_file::~mapped_file()
+    {
+        unmap();
+    } //! ~mapped_file()
+
+    const char* mapped_file::data() const
+    {
+        return _M_data;
+    } //! data()
+
+    size_t mapped_file::size() const
+    {
+        return _M_size;
+    } //! size()
+
+    std::string_view mapped_file::view() const
+    {
+        if (_M_data == nullptr)
+            return std::string_view();
+        return std::string_view(_M_data, _M_size);
+    } //! view()
+} //! namespace Fundraising::IO
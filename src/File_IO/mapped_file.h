@@ -0,0 +1,63 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H 1
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+namespace Fundraising::IO
+{
+    //A read-only file mapped into memory. The contents of the file
+    //can be accessed as one contiguous buffer for as long as the
+    //mapped_file is alive, without copying them onto the heap.
+    class mapped_file
+    {
+        public:
+            //How the contents will be read, passed on to the OS so it 
+            //knows whether reading ahead will pay off
+            enum class access_t
+            {
+                //No particular order, e.g. pieces read in parallel
+                NORMAL,
+                //Front to back, once
+                SEQUENTIAL
+            };
+
+            //Maps the specified file into memory. Throws a std::runtime_error
+            //if the file cannot be opened or mapped.
+            //@param filename the name of the file to map
+            //@param access how the contents will be read
+            explicit mapped_file(const std::string& filename, access_t access = access_t::NORMAL);
+            mapped_file(mapped_file&& other) noexcept;
+            mapped_file& operator=(mapped_file&& other) noexcept;
+            ~mapped_file();
+
+            //Returns a pointer to the first byte of the file
+            //@return pointer to the file contents. May be null for an empty file
+            const char* data() const;
+            //Returns the size of the file in bytes
+            //@return the size of the file
+            size_t size() const;
+            //Returns the contents of the file
+            //@return view of the whole file
+            std::string_view view() const;
+        private:
+            //Releases the mapping, if there is one
+            void unmap();
+        private:
+            const char* _M_data;
+            size_t _M_size;
+        #ifdef _WIN32
+            void* _M_file_handle;
+            void* _M_mapping_handle;
+        #else
+            int _M_fd;
+        #endif
+
+            //Disable copying, a mapping has a single owner
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+    }; //! mapped_file
+} //! namespace Fundraising::IO
+
+#endif
@@ -0,0 +1,254 @@
+#include "snapshot_io.h"
+#include "binary_io.h"
+#include "mapped_file.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+
+namespace Fundraising::IO
+{
+    //Identifies snapshot files and their layout. Bump the version 
+    //whenever the layout or the types in donation_t change.
+    static constexpr char SNAPSHOT_MAGIC[8] = {'F', 'R', 'S', 'N', 'A', 'P', 'S', 'H'};
+    static constexpr std::uint32_t SNAPSHOT_VERSION = 3;
+    //Written as a number so a snapshot from a host with another byte 
+    //order is rejected
+    static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    using text_column_t = const std::string& (*)(const Analysis::donation_t&);
+    //Text columns in the order they are stored and passed to donation_t()
+    static const std::array<text_column_t, 11> TEXT_COLUMNS = 
+    {
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_donor_first_name;},
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_donor_last_name;},
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_donor_email;},
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_donor_phone;},
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_donor_relation;},
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_dancer_name;},
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_dancer_email;},
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_dancer_house;},
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_dancer_team;},
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_dancer_role;},
+        [](const Analysis::donation_t& d) -> const std::string& {return d._M_dancer_id;}
+    };
+    //Positions in TEXT_COLUMNS of the columns donation_t keeps as symbols
+    static constexpr std::array<size_t, 4> SYMBOL_COLUMNS = {4, 7, 8, 9};
+
+    //What a snapshot was made from
+    struct source_key_t
+    {
+        std::uint64_t _M_size;
+        std::int64_t _M_mtime;
+        std::uint64_t _M_hash;
+    };
+
+    //Reads the size and modification time of a file
+    //@return false if the file cannot be found
+    static bool stat_source(const std::string& filename, source_key_t& key)
+    {
+        std::error_code error;
+        auto size = std::filesystem::file_size(filename, error);
+        if (error)
+            return false;
+        auto mtime = std::filesystem::last_write_time(filename, error);
+        if (error)
+            return false;
+        key._M_size = size;
+        key._M_mtime = static_cast<std::int64_t>(mtime.time_since_epoch().count());
+        key._M_hash = 0;
+        return true;
+    } //! stat_source()
+
+    //Hashes the contents of a file into its key
+    static void hash_source(const std::string& filename, source_key_t& key)
+    {
+        mapped_file source(filename, mapped_file::access_t::SEQUENTIAL);
+        key._M_hash = content_hash(source.view());
+    } //! hash_source()
+
+    std::string snapshot_filename(const std::string& filename)
+    {
+        return filename + ".snapshot";
+    } //! snapshot_filename()
+
+    //A text column read back from a snapshot. The values point into 
+    //the mapped snapshot.
+    struct text_column_view_t
+    {
+        std::vector<std::string_view> _M_values;
+        //The values interned, for symbol columns only
+        std::vector<Analysis::symbol_t> _M_symbols;
+        std::vector<std::uint32_t> _M_codes;
+    };
+
+    static text_column_view_t read_text_column(binary_reader& in, size_t num_rows)
+    {
+        text_column_view_t column;
+        auto num_values = in.read<std::uint32_t>();
+        auto offsets = in.read_array<std::uint64_t>(num_values + 1);
+        std::string_view blob = in.read_bytes(offsets.back());
+        column._M_values.reserve(num_values);
+        for (size_t i = 0; i < num_values; ++i)
+        {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > blob.size())
+                throw std::runtime_error("corrupt snapshot dictionary");
+            column._M_values.push_back(blob.substr(offsets[i], offsets[i + 1] - offsets[i]));
+        }
+        column._M_codes = in.read_array<std::uint32_t>(num_rows);
+        for (auto code: column._M_codes)
+        {
+            if (code >= num_values)
+                throw std::runtime_error("corrupt snapshot column");
+        }
+        return column;
+    } //! read_text_column()
+
+    static void write_text_column(binary_writer& out, const std::vector<Analysis::donation_t>& donations, text_column_t member)
+    {
+        std::unordered_map<std::string_view, std::uint32_t> dictionary;
+        std::vector<std::uint64_t> offsets = {0};
+        std::string blob;
+        std::vector<std::uint32_t> codes;
+        codes.reserve(donations.size());
+        for (const auto& donation: donations)
+        {
+            const std::string& value = member(donation);
+            auto [it, inserted] = dictionary.try_emplace(value, static_cast<std::uint32_t>(dictionary.size()));
+            if (inserted)
+            {
+                blob += value;
+                offsets.push_back(blob.size());
+            }
+            codes.push_back(it->second);
+        }
+        out.write<std::uint32_t>(static_cast<std::uint32_t>(dictionary.size()));
+        out.write_array(offsets);
+        out.write_bytes(blob);
+        out.write_array(codes);
+    } //! write_text_column()
+
+    bool stream_snapshot_donations(const std::string& filename, const std::function<void(const Analysis::donation_t&)>& consume, 
+        size_t num_donations)
+    {
+        source_key_t key;
+        std::string snapshot_name = snapshot_filename(filename);
+        if (!stat_source(filename, key) || !std::filesystem::exists(snapshot_name))
+            return false;
+        //Everything is decoded and checked before the first donation is
+        //consumed, so a damaged snapshot consumes nothing. Errors thrown
+        //by consume are the caller's and are passed on.
+        std::optional<mapped_file> snapshot;
+        size_t num_rows = 0;
+        std::vector<std::int64_t> timestamps, amounts;
+        std::array<text_column_view_t, TEXT_COLUMNS.size()> text;
+        try
+        {
+            snapshot.emplace(snapshot_name);
+            binary_reader in(snapshot->view());
+            if (in.read_bytes(sizeof(SNAPSHOT_MAGIC)) != std::string_view(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) ||
+                in.read<std::uint32_t>() != SNAPSHOT_VERSION || in.read<std::uint32_t>() != BYTE_ORDER_MARK)
+                return false;
+            auto saved = in.read<source_key_t>();
+            //Only hash the export once the cheap checks pass
+            if (saved._M_size != key._M_size || saved._M_mtime != key._M_mtime)
+                return false;
+            hash_source(filename, key);
+            if (saved._M_hash != key._M_hash)
+                return false;
+
+            num_rows = in.read<std::uint64_t>();
+            timestamps = in.read_array<std::int64_t>(num_rows);
+            amounts = in.read_array<std::int64_t>(num_rows);
+            for (auto& column: text)
+                column = read_text_column(in, num_rows);
+
+            //Intern each distinct value once rather than once per row
+            for (size_t c: SYMBOL_COLUMNS)
+                text[c]._M_symbols.assign(text[c]._M_values.begin(), text[c]._M_values.end());
+        } catch (const std::runtime_error& ex)
+        {
+            //A damaged snapshot is only a cache miss
+            std::cerr << "Warning: ignoring snapshot " << snapshot_name << ": " << ex.what() << std::endl;
+            return false;
+        }
+
+        if (num_donations != 0 && num_donations < num_rows)
+            num_rows = num_donations;
+        for (size_t i = 0; i < num_rows; ++i)
+        {
+            auto field = [&](size_t c) {return std::string(text[c]._M_values[text[c]._M_codes[i]]);};
+            auto symbol = [&](size_t c) {return text[c]._M_symbols[text[c]._M_codes[i]];};
+            Analysis::date_time_t timestamp;
+            timestamp._M_seconds = timestamps[i];
+            consume(Analysis::donation_t(
+                timestamp,
+                Analysis::money::from_cents(amounts[i]),
+                field(0), field(1), field(2), field(3), symbol(4), field(5),
+                field(6), symbol(7), symbol(8), symbol(9), field(10)));
+        }
+        return true;
+    } //! stream_snapshot_donations()
+
+    bool read_snapshot_donations(const std::string& filename, std::vector<Analysis::donation_t>& donations, 
+        size_t num_donations)
+    {
+        donations.clear();
+        donations.reserve(num_donations);
+        return stream_snapshot_donations(filename, [&donations](const Analysis::donation_t& donation) {donations.push_back(donation);}, 
+            num_donations);
+    } //! read_snapshot_donations()
+
+    void write_snapshot_donations(const std::string& filename, const std::vector<Analysis::donation_t>& donations)
+    {
+        std::string snapshot_name = snapshot_filename(filename);
+        std::string temp_name = snapshot_name + ".tmp";
+        try
+        {
+            source_key_t key;
+            if (!stat_source(filename, key))
+                return;
+            hash_source(filename, key);
+            {
+                std::ofstream file(temp_name, std::ios::binary | std::ios::trunc);
+                if (!file)
+                    throw std::runtime_error("cannot create " + temp_name);
+                binary_writer out(file);
+                out.write_bytes(std::string_view(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)));
+                out.write(SNAPSHOT_VERSION);
+                out.write(BYTE_ORDER_MARK);
+                out.write(key);
+                out.write<std::uint64_t>(donations.size());
+
+                std::vector<std::int64_t> values(donations.size());
+                auto write_column = [&](auto get)
+                {
+                    for (size_t i = 0; i < donations.size(); ++i)
+                        values[i] = get(donations[i]);
+                    out.write_array(values);
+                };
+                write_column([](const Analysis::donation_t& d) {return d._M_timestamp._M_seconds;});
+                write_column([](const Analysis::donation_t& d) {return d._M_amt.cents();});
+                for (auto member: TEXT_COLUMNS)
+                    write_text_column(out, donations, member);
+                if (!out.good())
+                    throw std::runtime_error("error writing " + temp_name);
+            }
+            //Replace the old snapshot in one step so readers never see half of one
+            std::filesystem::rename(temp_name, snapshot_name);
+        } catch (const std::exception& ex)
+        {
+            std::error_code ignored;
+            std::filesystem::remove(temp_name, ignored);
+            std::cerr << "Warning: could not save snapshot " << snapshot_name << ": " << ex.what() << std::endl;
+        }
+    } //! write_snapshot_donations()
+} //! namespace Fundraising::IO
@@ -0,0 +1,50 @@
+#ifndef SNAPSHOT_IO_H
+#define SNAPSHOT_IO_H 1
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "Analysis/basic_types.h"
+
+namespace Fundraising::IO
+{
+    //A snapshot is a binary copy of the donations parsed from an export,
+    //saved next to it so later runs on the same file can skip parsing.
+    //It records the size, modification time and a hash of the contents 
+    //of the export, and is ignored as soon as any of them change.
+    //
+    //Donations are stored column by column. Text columns are stored as
+    //a dictionary of distinct values and one index per donation, since 
+    //names, roles, houses and teams repeat across many rows.
+
+    //Returns the name of the snapshot kept for an export
+    //@param filename the name of the export
+    //@return the name of its snapshot
+    std::string snapshot_filename(const std::string& filename);
+
+    //Hands the donations saved in the snapshot of an export to consume,
+    //if there is an up to date snapshot
+    //@param filename the name of the export
+    //@param consume called with every donation, in file order
+    //@param num_donations the maximum number of donations to read, or 0 to read them all
+    //@return false if there is no usable snapshot. Nothing is consumed in that case. 
+    //Exceptions thrown by consume are passed on rather than treated as a bad snapshot.
+    bool stream_snapshot_donations(const std::string& filename, const std::function<void(const Analysis::donation_t&)>& consume, 
+        size_t num_donations = 0);
+
+    //Reads the donations saved in the snapshot of an export
+    //@param filename the name of the export
+    //@param donations receives the donations, in file order
+    //@param num_donations the maximum number of donations to read, or 0 to read them all
+    //@return false if there is no usable snapshot
+    bool read_snapshot_donations(const std::string& filename, std::vector<Analysis::donation_t>& donations, 
+        size_t num_donations = 0);
+
+    //Saves every donation parsed from an export to its snapshot. A 
+    //snapshot that cannot be written is skipped with a warning.
+    //@param filename the name of the export
+    //@param donations all of the donations in the export, in file order
+    void write_snapshot_donations(const std::string& filename, const std::vector<Analysis::donation_t>& donations);
+} //! namespace Fundraising::IO
+
+#endif
@@ -0,0 +1,63 @@
+#include "thread_pool.h"
+
+namespace Fundraising::Utility
+{
+    thread_pool::thread_pool(size_t num_threads)
+        : _M_workers(),
+        _M_tasks(),
+        _M_mutex(),
+        _M_cv(),
+        _M_stopping(false)
+    {
+        if (num_threads == 0)
+            num_threads = 1;
+        _M_workers.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i)
+            _M_workers.emplace_back([this]() {worker_loop();});
+    } //! thread_pool()
+
+    thread_pool::~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            _M_stopping = true;
+        }
+        _M_cv.notify_all();
+        for (auto& worker: _M_workers)
+            worker.join();
+    } //! ~thread_pool()
+
+    size_t thread_pool::size() const
+    {
+        return _M_workers.size();
+    } //! size()
+
+    thread_pool& thread_pool::instance()
+    {
+        static thread_pool pool;
+        return pool;
+    } //! instance()
+
+    size_t thread_pool::default_num_threads()
+    {
+        size_t num_threads = std::thread::hardware_concurrency();
+        return (num_threads == 0) ? 1 : num_threads;
+    } //! default_num_threads()
+
+    void thread_pool::worker_loop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_M_mutex);
+                _M_cv.wait(lock, [this]() {return _M_stopping || !_M_tasks.empty();});
+                if (_M_tasks.empty())
+                    return;
+                task = std::move(_M_tasks.front());
+                _M_tasks.pop_front();
+            }
+            task();
+        }
+    } //! worker_loop()
+} //! namespace Fundraising::Utility
@@ -0,0 +1,140 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H 1
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Fundraising::Utility
+{
+    //A fixed set of worker threads that run submitted tasks in FIFO order.
+    class thread_pool
+    {
+        public:
+            //Creates a new thread pool
+            //@param num_threads the number of worker threads. Defaults to one per core
+            explicit thread_pool(size_t num_threads = default_num_threads());
+            //Waits for queued tasks to finish and joins the workers
+            ~thread_pool();
+
+            //Queues a task to run on one of the workers
+            //@param func the task to run
+            //@return a future holding the task's result or exception
+            template<typename _FuncTp>
+            std::future<std::invoke_result_t<_FuncTp>> submit(_FuncTp&& func);
+
+            //Returns the number of worker threads
+            //@return the number of worker threads
+            size_t size() const;
+
+            //Returns the pool shared by the whole program
+            //@return the shared pool
+            static thread_pool& instance();
+            //Returns the number of hardware threads, or 1 if it is unknown
+            //@return the default number of worker threads
+            static size_t default_num_threads();
+        private:
+            //Runs tasks until the pool is stopped and the queue is empty
+            void worker_loop();
+        private:
+            std::vector<std::thread> _M_workers;
+            std::deque<std::function<void()>> _M_tasks;
+            std::mutex _M_mutex;
+            std::condition_variable _M_cv;
+            bool _M_stopping;
+
+            //Disable copying, the workers hold a pointer to the pool
+            thread_pool(const thread_pool&) = delete;
+            thread_pool& operator=(const thread_pool&) = delete;
+    }; //! thread_pool
+
+    template<typename _FuncTp>
+    std::future<std::invoke_result_t<_FuncTp>> thread_pool::submit(_FuncTp&& func)
+    {
+        using result_t = std::invoke_result_t<_FuncTp>;
+        //std::function must be copyable, packaged_task is not
+        auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<_FuncTp>(func));
+        std::future<result_t> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(_M_mutex);
+            _M_tasks.emplace_back([task]() {(*task)();});
+        }
+        _M_cv.notify_one();
+        return result;
+    } //! submit()
+
+    //Calls func(i) for every i in [0, n) using the shared pool and waits
+    //for all calls to finish. The calling thread takes part in the work,
+    //so it is safe to call from inside another pool task. If any call
+    //throws, the first exception is rethrown once all calls are done.
+    //@param n the number of iterations
+    //@param func the loop body, called with the iteration index
+    template<typename _FuncTp>
+    void parallel_for(size_t n, _FuncTp func)
+    {
+        if (n == 0)
+            return;
+        thread_pool& pool = thread_pool::instance();
+        if (n == 1 || pool.size() <= 1)
+        {
+            for (size_t i = 0; i < n; ++i)
+                func(i);
+            return;
+        }
+        //Shared with helpers that may only get to run after we return
+        struct state_t
+        {
+            std::atomic<size_t> _M_next{0};
+            std::atomic<size_t> _M_done{0};
+            std::exception_ptr _M_error;
+            std::mutex _M_mutex;
+            std::condition_variable _M_cv;
+        };
+        auto state = std::make_shared<state_t>();
+        auto run = [state, n, &func]()
+        {
+            size_t i;
+            while ((i = state->_M_next.fetch_add(1)) < n)
+            {
+                try
+                {
+                    func(i);
+                } catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(state->_M_mutex);
+                    if (!state->_M_error)
+                        state->_M_error = std::current_exception();
+                }
+                if (state->_M_done.fetch_add(1) + 1 == n)
+                {
+                    std::lock_guard<std::mutex> lock(state->_M_mutex);
+                    state->_M_cv.notify_all();
+                }
+            }
+        };
+        size_t num_helpers = std::min(n, pool.size()) - 1;
+        for (size_t h = 0; h < num_helpers; ++h)
+        {
+            //Helpers that start after every index is claimed return
+            //immediately without touching func
+            pool.submit([state, n, run]() {if (state->_M_next.load() < n) run();});
+        }
+        run();
+        std::unique_lock<std::mutex> lock(state->_M_mutex);
+        state->_M_cv.wait(lock, [&]() {return state->_M_done.load() == n;});
+        if (state->_M_error)
+            std::rethrow_exception(state->_M_error);
+    } //! parallel_for()
+} //! namespace Fundraising::Utility
+
+#endif
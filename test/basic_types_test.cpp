@@ -0,0 +1,64 @@
+#include "test_util.h"
+#include "Analysis/basic_types.h"
+#include <stdexcept>
+#include <string>
+
+using namespace Fundraising;
+using namespace Fundraising::Test;
+
+//Checks that an amount reads as a number of cents
+static void check_amount(const std::string& text, std::int64_t cents)
+{
+    try
+    {
+        check_equal(Analysis::make_donation(std::string_view(text)).cents(), cents, "amount \"" + text + "\"");
+    } catch (const std::runtime_error& ex)
+    {
+        check(false, "amount \"" + text + "\" threw " + ex.what());
+    }
+} //! check_amount()
+
+//Checks that an amount is rejected
+static void check_rejected(const std::string& text)
+{
+    try
+    {
+        Analysis::make_donation(std::string_view(text));
+        check(false, "amount \"" + text + "\" was accepted");
+    } catch (const std::runtime_error&) {}
+} //! check_rejected()
+
+int main()
+{
+    check_amount("25", 2500);
+    check_amount("20.5", 2050);
+    check_amount("20.05", 2005);
+    check_amount(".75", 75);
+    check_amount("$1,250.00", 125000);
+    check_amount("1,234,567", 123456700);
+    check_amount(" $40 ", 4000);
+    //Extra places are fine as long as they are zeros
+    check_amount("12.500", 1250);
+    //Refunds
+    check_amount("-5.00", -500);
+    check_amount("-$1,250.25", -125025);
+    check_amount("$-0.5", -50);
+
+    check_rejected("");
+    check_rejected("$");
+    check_rejected("-");
+    check_rejected("abc");
+    check_rejected("--5");
+    check_rejected("5-");
+    //Commas must separate groups of three digits
+    check_rejected("1,25");
+    check_rejected("12,50.00");
+    check_rejected(",100");
+    check_rejected("1,0000");
+    check_rejected("1000,000");
+    //More than two decimal places that change the amount
+    check_rejected("1.505");
+    check_rejected("20.001");
+    check_rejected("1.2.3");
+    return failures;
+}
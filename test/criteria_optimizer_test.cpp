@@ -0,0 +1,68 @@
+#include "test_util.h"
+#include "Analysis/criteria_optimizer.h"
+#include "Analysis/matching.h"
+#include "Analysis/scenarios.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Fundraising;
+using namespace Fundraising::Test;
+
+//Checks that the unused pools agree round by round
+static void check_unused(const std::vector<std::pair<Analysis::date_time_t, Analysis::donation_val_t>>& actual,
+    const std::vector<std::pair<Analysis::date_time_t, Analysis::donation_val_t>>& expected, const std::string& what)
+{
+    check_equal(actual.size(), expected.size(), what + " rounds");
+    for (size_t i = 0; i < actual.size() && i < expected.size(); ++i)
+    {
+        check(actual[i].first == expected[i].first, what + " end of round " + std::to_string(i));
+        check_equal(actual[i].second, expected[i].second, what + " round " + std::to_string(i));
+    }
+} //! check_unused()
+
+int main()
+{
+    using namespace Analysis;
+    std::vector<donation_t> donations = sample_donations(600, 2021);
+    //Rounds with gaps between them, latest first. The second set also
+    //has rounds before the first donation and after the last, which
+    //are skipped, and two rounds back to back.
+    std::vector<std::vector<matching_criterion_t>> bases = {
+        {sample_round(17, 18, money::from_dollars(1000), money::from_dollars(1000)),
+            sample_round(13, 14, money::from_dollars(1000), money::from_dollars(1000)),
+            sample_round(9, 11, money::from_dollars(1000), money::from_dollars(1000))},
+        {sample_round(21, 22, money::from_dollars(1000), money::from_dollars(1000)),
+            sample_round(15, 16, money::from_dollars(1000), money::from_dollars(1000)),
+            sample_round(12, 15, money::from_dollars(1000), money::from_dollars(1000)),
+            sample_round(6, 7, money::from_dollars(1000), money::from_dollars(1000))}
+    };
+    //Pools small enough to run out part way through a round and large
+    //enough to carry over, under caps that bind and caps that don't
+    std::vector<std::string> grid = {"general=0,300,2500,50000", "dancer=0,800,50000",
+        "max-per-donor=40,1000", "max-per-dancer=150,100000", "max-per-donation=25,1000"};
+
+    match_evaluator evaluator(donations);
+    check_equal(evaluator.size(), donations.size(), "evaluator size");
+    match_evaluator::workspace ws;
+    match_evaluator::evaluation_t result;
+    size_t num_candidates = 0;
+    for (const auto& base: bases)
+    {
+        for (const scenario_t& candidate: make_scenario_grid(base, grid))
+        {
+            evaluator.evaluate(candidate._M_rounds, ws, result);
+            matcher m(donations, candidate._M_rounds);
+            m.perform_matching_calculations();
+            donation_val_t matched;
+            for (const auto& [id, dancer]: m.get_matching_information())
+                matched += dancer._M_amt_matched;
+            check_equal(result._M_total_matched, matched, candidate._M_name + " total matched");
+            check_unused(result._M_unused_general, m.get_general_matching_money_left(), candidate._M_name + " unused general");
+            check_unused(result._M_unused_dancer, m.get_dancer_matching_money_left(), candidate._M_name + " unused dancer");
+            ++num_candidates;
+        }
+    }
+    check_equal(num_candidates, static_cast<size_t>(2*4*3*2*2*2), "candidates");
+    return failures;
+}
@@ -0,0 +1,72 @@
+#include "test_util.h"
+#include "File_IO/csv_io.h"
+#include "File_IO/csv_tokenizer.h"
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Fundraising;
+using namespace Fundraising::Test;
+
+//Reads every row of some CSV text
+//@param text the text to read
+//@return the rows, with the fields copied
+static std::vector<std::vector<std::string>> read_rows(std::string_view text)
+{
+    IO::csv_tokenizer tokenizer(text);
+    IO::csv_tokenizer::row_type row;
+    std::vector<std::vector<std::string>> rows;
+    while (tokenizer.read_row(row))
+        rows.emplace_back(row.begin(), row.end());
+    return rows;
+} //! read_rows()
+
+int main()
+{
+    //Rows whose quoted fields hold line endings, so many of the places
+    //a split is first tried are inside quotes
+    std::string body;
+    for (int i = 0; i < 200; ++i)
+    {
+        std::string n = std::to_string(i);
+        switch (i % 5)
+        {
+            case 0: body += n + ",\"line one\nline two\nline three\",plain\n"; break;
+            case 1: body += n + ",\"windows\r\nline\r\nendings\",\"a, b\"\r\n"; break;
+            case 2: body += "\"" + n + "\nquoted id\",\"say \\\"hi\\\"\nthen \\\\\",x\n\n"; break;
+            case 3: body += n + ",\"\n\n\n\",\"" + std::string(static_cast<size_t>(i), 'y') + "\n\"\r"; break;
+            default: body += n + ",unquoted,row\n"; break;
+        }
+    }
+    std::vector<std::vector<std::string>> expected = read_rows(body);
+    check_equal(expected.size(), static_cast<size_t>(200), "rows read in one piece");
+
+    size_t max_pieces = 0;
+    for (size_t num_chunks = 1; num_chunks <= 256; ++num_chunks)
+    {
+        std::vector<std::string_view> chunks = IO::split_csv_rows(body, num_chunks);
+        std::string what = std::to_string(num_chunks) + " chunks";
+        check(!chunks.empty() && chunks.size() <= num_chunks, what + " count");
+        max_pieces = std::max(max_pieces, chunks.size());
+        //The pieces cover the text, in order, with nothing left out
+        size_t covered = 0;
+        for (std::string_view chunk: chunks)
+        {
+            check(chunk.data() == body.data() + covered, what + " contiguous");
+            covered += chunk.size();
+        }
+        check_equal(covered, body.size(), what + " covered");
+
+        std::vector<std::vector<std::string>> rows;
+        for (std::string_view chunk: chunks)
+        {
+            std::vector<std::vector<std::string>> chunk_rows = read_rows(chunk);
+            rows.insert(rows.end(), chunk_rows.begin(), chunk_rows.end());
+        }
+        check_equal(rows.size(), expected.size(), what + " rows");
+        check(rows == expected, what + " row contents");
+    }
+    check(max_pieces > 50, "text split into many pieces");
+    return failures;
+}
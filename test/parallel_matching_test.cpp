@@ -0,0 +1,82 @@
+#include "test_util.h"
+#include "Analysis/matching.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Fundraising;
+using namespace Fundraising::Test;
+
+//Checks that the unused pools agree round by round
+static void check_unused(const std::vector<std::pair<Analysis::date_time_t, Analysis::donation_val_t>>& actual,
+    const std::vector<std::pair<Analysis::date_time_t, Analysis::donation_val_t>>& expected, const std::string& what)
+{
+    check_equal(actual.size(), expected.size(), what + " rounds");
+    for (size_t i = 0; i < actual.size() && i < expected.size(); ++i)
+    {
+        check(actual[i].first == expected[i].first, what + " end of round " + std::to_string(i));
+        check_equal(actual[i].second, expected[i].second, what + " round " + std::to_string(i));
+    }
+} //! check_unused()
+
+//Matches the donations one at a time and all at once, and checks that
+//every dancer, donor ledger and unused pool comes out the same
+//@param donations the donations, in timestamp order
+//@param rounds the matching rounds, latest first
+//@param what the name of the case, printed on failure
+static void check_same(const std::vector<Analysis::donation_t>& donations,
+    const std::vector<Analysis::matching_criterion_t>& rounds, const std::string& what)
+{
+    using namespace Analysis;
+    matcher serial(rounds);
+    for (const donation_t& donation: donations)
+        serial.add_donation(donation);
+    matcher parallel(donations, rounds);
+    parallel.perform_matching_calculations();
+
+    const auto& serial_dancers = serial.get_matching_information();
+    const auto& parallel_dancers = parallel.get_matching_information();
+    check_equal(parallel_dancers.size(), serial_dancers.size(), what + " dancers");
+    for (const auto& [id, dancer]: serial_dancers)
+    {
+        auto it = parallel_dancers.find(id);
+        if (it == parallel_dancers.end())
+        {
+            check(false, what + " dancer " + id + " missing");
+            continue;
+        }
+        check_equal(it->second._M_amt_raised, dancer._M_amt_raised, what + " " + id + " raised");
+        check_equal(it->second._M_amt_matched, dancer._M_amt_matched, what + " " + id + " matched");
+        check(it->second._M_donors == dancer._M_donors, what + " " + id + " donor ledger");
+    }
+    check_unused(parallel.get_general_matching_money_left(), serial.get_general_matching_money_left(), what + " unused general");
+    check_unused(parallel.get_dancer_matching_money_left(), serial.get_dancer_matching_money_left(), what + " unused dancer");
+} //! check_same()
+
+int main()
+{
+    using namespace Analysis;
+    std::vector<donation_t> donations = sample_donations(2000, 11302021);
+    money small = money::from_dollars(600);
+    money large = money::from_dollars(1000000);
+
+    //Pools that run out part way through each round, so dancers are
+    //rebuilt and matched one donation at a time from then on
+    check_same(donations, {sample_round(17, 18, small, small), sample_round(13, 14, small, small),
+        sample_round(9, 11, small, small)}, "exhausted pools");
+    //Only the dancer pool or only the general pool runs out
+    check_same(donations, {sample_round(14, 16, large, small), sample_round(9, 12, small, large)}, "one pool exhausted");
+    //Pools that never run out, so every donation is matched in full
+    check_same(donations, {sample_round(14, 16, large, large), sample_round(9, 12, large, large)}, "pools left over");
+    //Rounds that don't follow one another: back to back, overlapping
+    //the one before, before the first donation and after the last. Each
+    //is entered or skipped as the donations reach it.
+    check_same(donations, {sample_round(21, 23, small, small), sample_round(15, 16, small, small),
+        sample_round(12, 15, small, small), sample_round(11, 13, small, small), sample_round(5, 7, small, small)},
+        "out of order rounds");
+    //No donations at all in the first rounds
+    check_same(std::vector<donation_t>(donations.begin() + donations.size()/2, donations.end()),
+        {sample_round(16, 18, small, small), sample_round(10, 11, small, small), sample_round(8, 9, small, small)},
+        "skipped rounds");
+    return failures;
+}
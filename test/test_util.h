@@ -0,0 +1,110 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H 1
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Analysis/basic_types.h"
+#include "Analysis/matching_base.h"
+
+namespace Fundraising::Test
+{
+    //Number of failed checks so far. main() returns it, so a test
+    //program fails if any check did.
+    inline int failures = 0;
+
+    //Records a failed check unless the condition holds
+    //@param ok the condition that should hold
+    //@param what what was checked, printed on failure
+    inline void check(bool ok, const std::string& what)
+    {
+        if (ok)
+            return;
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    } //! check()
+
+    //Checks that two values are equal, printing both if they aren't
+    //@param actual the value worked out
+    //@param expected the value it should be
+    //@param what what was checked, printed on failure
+    template<typename _Tp, typename _Up>
+    void check_equal(const _Tp& actual, const _Up& expected, const std::string& what)
+    {
+        if (actual == expected)
+            return;
+        std::cerr << "FAILED: " << what << ": got " << actual << ", expected " << expected << std::endl;
+        ++failures;
+    } //! check_equal()
+
+    //Builds a day of donations, in timestamp order, that exercises the
+    //matcher's rules. Donors give to several dancers and some donations
+    //link a phone seen for one donor with an email seen for another, so
+    //donors are merged part way through. Some dancers are DMUM members,
+    //who aren't matched, or leadership, who are matched from the general
+    //pool only.
+    //@param count the number of donations
+    //@param seed picks the amounts, donors and dancers
+    //@return the donations
+    inline std::vector<Analysis::donation_t> sample_donations(size_t count, std::uint32_t seed)
+    {
+        using namespace Analysis;
+        std::uint32_t state = seed;
+        auto next = [&state](std::uint32_t bound)
+        {
+            state = state*1664525u + 1013904223u;
+            return (state >> 8) % bound;
+        };
+        static const char* const roles[] = {"Dancer", "Dancer", "Dancer", "Dancer", "DMUM", "Leadership"};
+        static const char* const relations[] = {"Parent", "Friend", "DMUM Alumni"};
+        const size_t num_dancers = 12;
+        const size_t num_donors = count/3 + 1;
+
+        std::vector<donation_t> donations;
+        donations.reserve(count);
+        //Spread over 08:00 to 20:00, a donation every 30 to 150 seconds
+        //in the morning so the times land inside and between rounds
+        date_time_t timestamp(2021, 11, 30, 8, 0, 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            timestamp._M_seconds += static_cast<std::int64_t>(43200/count)/2 + next(43200/count);
+            size_t dancer = next(num_dancers);
+            size_t donor = next(num_donors);
+            std::string phone = "(555) 010-" + std::to_string(1000 + donor);
+            std::string email = "donor" + std::to_string(donor) + "@example.com";
+            //Every so often a donor gives with someone else's email,
+            //linking the two, or with only one of their phone or email
+            switch (next(10))
+            {
+                case 0: email = "DONOR" + std::to_string(next(num_donors)) + "@Example.com "; break;
+                case 1: phone.clear(); break;
+                case 2: email.clear(); break;
+                default: break;
+            }
+            donation_val_t amt = money::from_cents(500 + 100*static_cast<std::int64_t>(next(300)) + next(2)*50);
+            donations.emplace_back(timestamp, amt, "First" + std::to_string(donor), "Last", email, phone,
+                symbol_t(relations[next(3)]), "Dancer " + std::to_string(dancer),
+                "dancer" + std::to_string(dancer) + "@umich.edu", symbol_t("House " + std::to_string(dancer % 3)),
+                symbol_t("Team " + std::to_string(dancer % 4)), symbol_t(roles[dancer % 6]),
+                "P" + std::to_string(dancer));
+        }
+        return donations;
+    } //! sample_donations()
+
+    //Makes one matching round
+    //@param start_hour the hour the round starts, on the day of sample_donations()
+    //@param end_hour the hour the round ends
+    //@param general the general pool
+    //@param dancer the dancer pool
+    //@return the round, with caps that bind for some donations
+    inline Analysis::matching_criterion_t sample_round(int start_hour, int end_hour,
+        Analysis::donation_val_t general, Analysis::donation_val_t dancer)
+    {
+        using namespace Analysis;
+        return {general, dancer, money::from_dollars(150), money::from_dollars(400), money::from_dollars(100),
+            date_time_t(2021, 11, 30, start_hour), date_time_t(2021, 11, 30, end_hour)};
+    } //! sample_round()
+} //! namespace Fundraising::Test
+
+#endif